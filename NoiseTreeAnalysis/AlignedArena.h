@@ -0,0 +1,58 @@
+#ifndef AlignedArena_h_
+#define AlignedArena_h_
+
+//
+// Owns a single object of type T placed at the beginning of a cache
+// line. Intended for structs of per-event working arrays: the whole
+// struct is allocated once, in one piece, and the arrays keep their
+// addresses for the lifetime of the arena (which is needed by functors
+// remembering these addresses at histogram booking time).
+//
+// If all arrays in the struct occupy a whole number of cache lines
+// each, every one of them starts at a cache line boundary.
+//
+// Typical usage:
+//
+//   struct Arrays {double x[1024]; float y[1024];};
+//   AlignedArena<Arrays> arena;
+//   arena->x[i] = something;
+//
+
+#include <new>
+#include <cassert>
+
+template <class T, unsigned long Alignment = 64UL>
+class AlignedArena
+{
+public:
+    // The object is value-initialized (zero-filled for plain structs)
+    inline AlignedArena()
+        : mem_(::operator new(sizeof(T) + Alignment - 1UL)), obj_(0)
+    {
+        static_assert(Alignment && !(Alignment & (Alignment - 1UL)),
+                      "Alignment must be a power of 2");
+        const unsigned long addr = reinterpret_cast<unsigned long>(mem_);
+        void* aligned = static_cast<char*>(mem_) +
+            ((Alignment - addr % Alignment) % Alignment);
+        obj_ = new (aligned) T();
+    }
+
+    inline ~AlignedArena()
+    {
+        obj_->~T();
+        ::operator delete(mem_);
+    }
+
+    inline T* get() const {return obj_;}
+    inline T* operator->() const {return obj_;}
+    inline T& operator*() const {return *obj_;}
+
+private:
+    AlignedArena(const AlignedArena&);
+    AlignedArena& operator=(const AlignedArena&);
+
+    void* mem_;
+    T* obj_;
+};
+
+#endif // AlignedArena_h_
@@ -0,0 +1,29 @@
+#ifndef AnalysisList_h_
+#define AnalysisList_h_
+
+//
+// Compile-time list of analysis classes for the executables which run
+// several analyses over a single read of the input (see RootChainGroup.h
+// and multiAnalysisExecutableTemplate.C). The list is built by nesting,
+// for example:
+//
+// typedef AnalysisList<Analysis0,
+//         AnalysisList<Analysis1,
+//         AnalysisList<Analysis2> > > AnalysisClasses;
+//
+
+struct NoMoreAnalyses
+{
+    enum {length = 0};
+};
+
+template <class Analysis, class Next = NoMoreAnalyses>
+struct AnalysisList
+{
+    typedef Analysis analysis_type;
+    typedef Next next_type;
+
+    enum {length = 1 + Next::length};
+};
+
+#endif // AnalysisList_h_
@@ -0,0 +1,213 @@
+#ifndef ChannelGroupAccumulator_h_
+#define ChannelGroupAccumulator_h_
+
+//
+// Single-pass filling of ChannelGroupInfo summaries for a fixed
+// collection of channel groups (e.g., all HPDs or all static HPD
+// neighborhoods).
+//
+// The membership table (channel -> groups which contain it) is built
+// once, in the constructor. For each event, the pulses are visited
+// once and every pulse is added to all groups it belongs to. Then
+// only the groups which received at least one pulse are finalized.
+// The groups touched in the previous event are reset, all others
+// are left alone. Because of this, the same output array must be
+// passed to every "fill" call.
+//
+// If "countReadoutOnly" is true, the number of members of each group
+// is set to the number of channels read out in the event (as if the
+// group was made of the read out channels only). Otherwise it is the
+// size of the corresponding member list.
+//
+// The summaries agree with those made by ChannelGroupInfo::fill up to
+// rounding. The pulses are added in the pulse order rather than in the
+// order of the member lists, so the floating point sums (energies,
+// charges) can differ in the last bits.
+//
+
+#include <vector>
+#include <cassert>
+#include <cstring>
+
+#include "ChannelGroupInfo.h"
+
+class ChannelGroupAccumulator
+{
+public:
+    // "memberLists" must have "nGroups" elements. All channel
+    // numbers in these lists must be less than "nChannels".
+    inline ChannelGroupAccumulator(const std::vector<unsigned>* memberLists,
+                                   const unsigned nGroups,
+                                   const unsigned nChannels,
+                                   const bool countReadoutOnly)
+        : firstGroup_(nChannels + 1U, 0U),
+          nMembers_(nGroups),
+          sums_(nGroups),
+          countReadoutOnly_(countReadoutOnly),
+          initialized_(false)
+    {
+        assert(memberLists || !nGroups);
+
+        // Count the groups for each channel, then fill the table
+        for (unsigned g=0; g<nGroups; ++g)
+        {
+            const std::vector<unsigned>& members(memberLists[g]);
+            const unsigned n = members.size();
+            nMembers_[g] = n;
+            for (unsigned i=0; i<n; ++i)
+            {
+                assert(members[i] < nChannels);
+                ++firstGroup_[members[i] + 1U];
+            }
+        }
+        for (unsigned ch=0; ch<nChannels; ++ch)
+            firstGroup_[ch + 1U] += firstGroup_[ch];
+
+        groups_.resize(firstGroup_[nChannels]);
+        std::vector<unsigned> pos(firstGroup_.begin(), firstGroup_.end()-1);
+        for (unsigned g=0; g<nGroups; ++g)
+        {
+            const std::vector<unsigned>& members(memberLists[g]);
+            const unsigned n = members.size();
+            for (unsigned i=0; i<n; ++i)
+                groups_[pos[members[i]]++] = g;
+        }
+
+        touched_.reserve(nGroups);
+    }
+
+    inline unsigned nGroups() const {return nMembers_.size();}
+
+    // Groups which received at least one pulse in the last "fill" call
+    inline const std::vector<unsigned>& touchedGroups() const
+        {return touched_;}
+
+    // "channelNumber" maps pulse numbers into channel numbers.
+    // "startingSlice" and "filterSums" are indexed by pulse number
+    // and have the same meaning as in ChannelGroupInfo::fill.
+    // "out" must have nGroups() elements.
+    template<class NoiseTreeData>
+    void fill(const HBHEChannelGeometry& geometry,
+              const NoiseTreeData& treeData, const unsigned nPulses,
+              const unsigned* channelNumber,
+              const Filter10& startTimeFilter,
+              const unsigned tStart, const unsigned tEnd,
+              const unsigned* startingSlice,
+              const double* filterSums,
+              ChannelGroupInfo* out)
+    {
+        assert(out);
+        assert(channelNumber || !nPulses);
+        assert(startingSlice || !nPulses);
+        assert(filterSums || !nPulses);
+
+        // Clean up the results of the previous event
+        const unsigned nG = nGroups();
+        if (initialized_)
+        {
+            const unsigned nOld = touched_.size();
+            for (unsigned i=0; i<nOld; ++i)
+                resetGroup(touched_[i], out);
+        }
+        else
+        {
+            for (unsigned g=0; g<nG; ++g)
+                resetGroup(g, out);
+            initialized_ = true;
+        }
+        touched_.clear();
+
+        // Scatter the pulses into their groups
+        for (unsigned ip=0; ip<nPulses; ++ip)
+        {
+            const unsigned ichan = channelNumber[ip];
+            assert(ichan + 1U < firstGroup_.size());
+            const unsigned gEnd = firstGroup_[ichan + 1U];
+            unsigned ig = firstGroup_[ichan];
+            if (ig == gEnd)
+                continue;
+
+            const double e = treeData.Energy[ip];
+            const TVector3& dir = geometry.getDirection(ichan);
+            const double ex = dir.X()*e;
+            const double ey = dir.Y()*e;
+            const double ez = dir.Z()*e;
+            const double* ch = &treeData.Charge[ip][0];
+            const double w = filterSums[ip];
+            const double tw = startingSlice[ip]*w;
+
+            for (; ig<gEnd; ++ig)
+            {
+                const unsigned g = groups_[ig];
+                ChannelGroupInfo& info(out[g]);
+                GroupSums& s(sums_[g]);
+                if (!info.nReadout)
+                {
+                    touched_.push_back(g);
+                    s.ex = 0.0;
+                    s.ey = 0.0;
+                    s.ez = 0.0;
+                    s.wSum = 0.0;
+                    s.tSum = 0.0;
+                }
+                ++info.nReadout;
+                info.energySum += e;
+                for (unsigned k=0; k<10; ++k)
+                    info.charge[k] += ch[k];
+                s.ex += ex;
+                s.ey += ey;
+                s.ez += ez;
+                if (w > 0.0)
+                {
+                    s.wSum += w;
+                    s.tSum += tw;
+                }
+            }
+        }
+
+        // Finalize the touched groups
+        const unsigned nTouched = touched_.size();
+        for (unsigned i=0; i<nTouched; ++i)
+        {
+            const unsigned g = touched_[i];
+            ChannelGroupInfo& info(out[g]);
+            const GroupSums& s(sums_[g]);
+            if (countReadoutOnly_)
+                info.nMembers = info.nReadout;
+            info.finish(startTimeFilter, tStart, tEnd,
+                        TVector3(s.ex, s.ey, s.ez), s.wSum, s.tSum);
+        }
+    }
+
+private:
+    ChannelGroupAccumulator();
+
+    struct GroupSums
+    {
+        double ex;
+        double ey;
+        double ez;
+        double wSum;
+        double tSum;
+    };
+
+    inline void resetGroup(const unsigned g, ChannelGroupInfo* out) const
+    {
+        out[g].reset();
+        if (!countReadoutOnly_)
+            out[g].nMembers = nMembers_[g];
+    }
+
+    // Compressed membership table: the groups of channel "ch"
+    // are groups_[firstGroup_[ch]], ..., groups_[firstGroup_[ch+1]-1]
+    std::vector<unsigned> firstGroup_;
+    std::vector<unsigned> groups_;
+
+    std::vector<unsigned> nMembers_;
+    std::vector<GroupSums> sums_;
+    std::vector<unsigned> touched_;
+    bool countReadoutOnly_;
+    bool initialized_;
+};
+
+#endif // ChannelGroupAccumulator_h_
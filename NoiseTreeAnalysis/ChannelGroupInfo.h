@@ -10,6 +10,7 @@
 
 #include <cassert>
 #include <cstring>
+#include <numeric>
 #include <algorithm>
 
 #include "Filter10.h"
@@ -110,8 +111,22 @@ struct ChannelGroupInfo
             }
         }
 
+        finish(startTimeFilter, tStart, tEnd, EtSum, wSum, tSum);
+    }
+
+    // Calculate the derived quantities once "nReadout", "charge",
+    // and "energySum" are accumulated. "EtSum" is the vector sum of
+    // transverse energies, while "wSum" and "tSum" are the sums of
+    // filter charge weights and weighted starting time slices.
+    void finish(const Filter10& startTimeFilter,
+                const unsigned tStart, const unsigned tEnd,
+                const TVector3& EtSum, const double wSum, const double tSum)
+    {
         if (nReadout)
         {
+            assert(tStart <= tEnd);
+            assert(tEnd <= 10);
+
             chargeSum = std::accumulate(
                 charge, charge + sizeof(charge)/sizeof(charge[0]), 0.0);
             chargeInWindow = std::accumulate(charge+tStart, charge+tEnd, 0.0);
@@ -0,0 +1,82 @@
+#ifndef ChargeWindowSums_h_
+#define ChargeWindowSums_h_
+
+//
+// Prefix sums of the time slice charges for all pulses of an event.
+// After "fill" is called, the sum over any range of time slices
+// of any pulse is obtained in constant time, so that windowed
+// quantities can be added without extra loops over the time slices.
+//
+// The sums are kept in one contiguous array, 11 entries per pulse.
+// Entry t of pulse p is the sum of the slices 0, ..., t-1.
+//
+
+#include <vector>
+#include <cassert>
+
+class ChargeWindowSums
+{
+public:
+    enum {
+        NSlices = 10,
+        NEntries = NSlices + 1
+    };
+
+    inline explicit ChargeWindowSums(const unsigned maxPulses = 0)
+        : sums_(maxPulses*NEntries), nPulses_(0) {}
+
+    // "data" must have nPulses*NSlices elements, with
+    // the slices of each pulse stored consecutively
+    template<class Data>
+    inline void fill(const Data* data, const unsigned nPulses)
+    {
+        if (sums_.size() < nPulses*NEntries)
+            sums_.resize(nPulses*NEntries);
+        nPulses_ = nPulses;
+        if (!nPulses)
+            return;
+        assert(data);
+
+        double* s = &sums_[0];
+        for (unsigned p=0; p<nPulses; ++p, s+=NEntries, data+=NSlices)
+        {
+            s[0] = 0.0;
+            for (unsigned t=0; t<NSlices; ++t)
+                s[t+1] = s[t] + data[t];
+        }
+    }
+
+    inline unsigned nPulses() const {return nPulses_;}
+
+    // Sum of the slices t1, ..., t2-1 for the given pulse.
+    // Must have t1 <= t2 <= NSlices.
+    inline double windowSum(const unsigned pulse, const unsigned t1,
+                            const unsigned t2) const
+    {
+        assert(pulse < nPulses_);
+        assert(t1 <= t2 && t2 <= NSlices);
+        const double* s = &sums_[pulse*NEntries];
+        return s[t2] - s[t1];
+    }
+
+    // Sum over all slices of the given pulse
+    inline double total(const unsigned pulse) const
+        {return windowSum(pulse, 0U, NSlices);}
+
+    // Window sums for all pulses at once
+    inline void windowSums(const unsigned t1, const unsigned t2,
+                           double* out) const
+    {
+        assert(t1 <= t2 && t2 <= NSlices);
+        assert(out || !nPulses_);
+        const double* s = nPulses_ ? &sums_[0] : 0;
+        for (unsigned p=0; p<nPulses_; ++p, s+=NEntries)
+            out[p] = s[t2] - s[t1];
+    }
+
+private:
+    std::vector<double> sums_;
+    unsigned nPulses_;
+};
+
+#endif // ChargeWindowSums_h_
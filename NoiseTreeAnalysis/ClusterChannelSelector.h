@@ -0,0 +1,81 @@
+#ifndef ClusterChannelSelector_h_
+#define ClusterChannelSelector_h_
+
+//
+// Channel selector which clusters energetic channels directly on the
+// HBHE neighbor graph (see HBHEChannelMap::channelNeighbors).
+//
+// Channels with Et above "cellEtCutoff" are joined into connected
+// components using a union-find structure. A component becomes a cluster
+// if it contains at least one channel with Et above "seedEtCutoff".
+// Channels in the cluster and the read out channels adjacent to it
+// are associated with the cluster. A channel adjacent to several
+// clusters is associated with the one which has the largest Et.
+// The mask is set for the associated channels if the cluster Et
+// exceeds "clusterEtCutoff".
+//
+// The time needed for selection is proportional to the number
+// of channels read out.
+//
+
+#include <vector>
+
+#include "AbsChannelSelector.h"
+#include "HBHEChannelMap.h"
+#include "HBHEChannelGeometry.h"
+
+template <class AnalysisClass>
+class ClusterChannelSelector : public AbsChannelSelector<AnalysisClass>
+{
+public:
+    ClusterChannelSelector(const HBHEChannelMap& channelMap,
+                           const HBHEChannelGeometry& geometry,
+                           double cellEtCutoff, double seedEtCutoff,
+                           double clusterEtCutoff);
+
+    inline virtual ~ClusterChannelSelector() {}
+
+    virtual void select(const AnalysisClass& event,
+                        std::vector<unsigned char>* mask,
+                        std::vector<double>* parentPt);
+
+    // Number of clusters made in the last event
+    inline unsigned nClusters() const {return nClusters_;}
+
+private:
+    ClusterChannelSelector();
+
+    unsigned findRoot(unsigned channel);
+    void join(unsigned ch1, unsigned ch2);
+
+    // Channel numbering scheme
+    const HBHEChannelMap& channelMap_;
+
+    // Parameters specified in the constructor
+    double cellEtCutoff_;
+    double seedEtCutoff_;
+    double clusterEtCutoff_;
+
+    // Factors for converting channel energy into Et
+    std::vector<double> chanPerp_;
+
+    // Per-channel work arrays. Only the entries for the channels
+    // listed in "touched_" differ from their default values.
+    int pulseNumber_[HBHEChannelMap::ChannelCount];
+    unsigned parent_[HBHEChannelMap::ChannelCount];
+    double chanEt_[HBHEChannelMap::ChannelCount];
+    double clusterEt_[HBHEChannelMap::ChannelCount];
+    double associatedEt_[HBHEChannelMap::ChannelCount];
+    bool active_[HBHEChannelMap::ChannelCount];
+    bool seeded_[HBHEChannelMap::ChannelCount];
+    std::vector<unsigned> touched_;
+
+    // Channels above the cell threshold in the current event
+    std::vector<unsigned> activeChannels_;
+
+    unsigned nClusters_;
+};
+
+#include "ClusterChannelSelector.icc"
+
+#endif // ClusterChannelSelector_h_
@@ -0,0 +1,158 @@
+#ifndef DerivedQuantityRecord_h_
+#define DerivedQuantityRecord_h_
+
+//
+// Serialization of the per-event derived quantities (pulse charge sums,
+// HPD summaries, etc) into a byte buffer. Such records are stored in
+// the sidecar files (see DerivedQuantitySidecar.h) and passed from the
+// worker threads to the filling thread in the pipelined processing
+// (see RootChainPipeline.h).
+//
+// A record contains the number of pulses followed by the columns, in
+// the order they were added. Pulse columns have one value per pulse.
+// Group columns consist of the number of groups followed by the group
+// numbers and the ChannelGroupInfo objects for these groups. The native
+// byte order is used.
+//
+
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+
+#include "ChannelGroupInfo.h"
+
+class DerivedQuantityWriter
+{
+public:
+    // The buffer is cleared and then filled by the "add..." methods
+    inline DerivedQuantityWriter(std::vector<char>* buf, const unsigned nPulses)
+        : buf_(buf), nPulses_(nPulses)
+    {
+        assert(buf_);
+        buf_->resize(sizeof(nPulses_));
+        memcpy(&(*buf_)[0], &nPulses_, sizeof(nPulses_));
+    }
+
+    inline unsigned nPulses() const {return nPulses_;}
+
+    // The values are converted to type "Stored" before writing
+    template<typename Stored, typename T>
+    inline void addPulseColumn(const T* values)
+    {
+        assert(values || !nPulses_);
+        char* out = grow(nPulses_*sizeof(Stored));
+        for (unsigned i=0; i<nPulses_; ++i, out+=sizeof(Stored))
+        {
+            const Stored s = static_cast<Stored>(values[i]);
+            memcpy(out, &s, sizeof(Stored));
+        }
+    }
+
+    // Store the summaries of the listed groups only
+    inline void addGroupColumn(const ChannelGroupInfo* infos,
+                               const std::vector<unsigned>& groups)
+    {
+        const unsigned nGroups = groups.size();
+        assert(infos || !nGroups);
+        memcpy(grow(sizeof(nGroups)), &nGroups, sizeof(nGroups));
+        if (nGroups)
+            memcpy(grow(nGroups*sizeof(unsigned)), &groups[0],
+                   nGroups*sizeof(unsigned));
+        for (unsigned i=0; i<nGroups; ++i)
+            memcpy(grow(sizeof(ChannelGroupInfo)), infos + groups[i],
+                   sizeof(ChannelGroupInfo));
+    }
+
+private:
+    inline char* grow(const unsigned long nBytes)
+    {
+        const unsigned long pos = buf_->size();
+        buf_->resize(pos + nBytes);
+        return nBytes ? &(*buf_)[pos] : 0;
+    }
+
+    std::vector<char>* buf_;
+    unsigned nPulses_;
+};
+
+class DerivedQuantityReader
+{
+public:
+    // The buffer must not be modified while this object is in use.
+    // std::runtime_error is thrown if the record is malformed.
+    inline explicit DerivedQuantityReader(const std::vector<char>& buf)
+        : buf_(buf), pos_(0UL), nPulses_(0U)
+    {
+        memcpy(&nPulses_, take(sizeof(nPulses_)), sizeof(nPulses_));
+    }
+
+    inline unsigned nPulses() const {return nPulses_;}
+
+    // The columns must be extracted in the same order
+    // as they were added
+    template<typename Stored, typename T>
+    inline void getPulseColumn(T* values)
+    {
+        assert(values || !nPulses_);
+        const char* in = take(nPulses_*sizeof(Stored));
+        for (unsigned i=0; i<nPulses_; ++i, in+=sizeof(Stored))
+        {
+            Stored s;
+            memcpy(&s, in, sizeof(Stored));
+            values[i] = s;
+        }
+    }
+
+    // The group numbers are placed into "groups" and the
+    // summaries are copied into the corresponding elements
+    // of "infos". Other elements of "infos" are not modified.
+    inline void getGroupColumn(ChannelGroupInfo* infos, const unsigned nInfos,
+                               std::vector<unsigned>* groups)
+    {
+        assert(groups);
+        unsigned nGroups;
+        memcpy(&nGroups, take(sizeof(nGroups)), sizeof(nGroups));
+        groups->resize(nGroups);
+        if (nGroups)
+        {
+            assert(infos);
+            memcpy(&(*groups)[0], take(nGroups*sizeof(unsigned)),
+                   nGroups*sizeof(unsigned));
+        }
+        for (unsigned i=0; i<nGroups; ++i)
+        {
+            const unsigned g = (*groups)[i];
+            if (g >= nInfos)
+                fail("getGroupColumn", "group number out of range");
+            memcpy(infos + g, take(sizeof(ChannelGroupInfo)),
+                   sizeof(ChannelGroupInfo));
+        }
+    }
+
+private:
+    DerivedQuantityReader();
+
+    inline const char* take(const unsigned long nBytes)
+    {
+        if (pos_ + nBytes > buf_.size())
+            fail("take", "record is shorter than expected");
+        const char* p = nBytes ? &buf_[pos_] : 0;
+        pos_ += nBytes;
+        return p;
+    }
+
+    static inline void fail(const char* where, const char* reason)
+    {
+        std::ostringstream os;
+        os << "In DerivedQuantityReader::" << where << ": " << reason;
+        throw std::runtime_error(os.str());
+    }
+
+    const std::vector<char>& buf_;
+    unsigned long pos_;
+    unsigned nPulses_;
+};
+
+#endif // DerivedQuantityRecord_h_
@@ -0,0 +1,78 @@
+#ifndef DerivedQuantitySidecar_h_
+#define DerivedQuantitySidecar_h_
+
+//
+// Binary "sidecar" file for per-event quantities derived from the tree
+// data (pulse charge sums, HPD summaries, etc). Such a file is written
+// once, and later runs which only change histogram binning or selection
+// can read the derived quantities back instead of recalculating them
+// from the raw charges.
+//
+// The file starts with a header of four 64-bit words: magic number,
+// format version, the bit mask of the quantities stored (its meaning
+// is defined by the code which writes the file), and a "configuration"
+// word which can be used to check that the quantities were calculated
+// with compatible settings. The header is followed by event records.
+// Each record begins with the entry number in the chain and the record
+// size (two 64-bit words). The record body is made by
+// DerivedQuantityWriter and decoded by DerivedQuantityReader (see
+// DerivedQuantityRecord.h). The native byte order is used.
+//
+// The records must be written with increasing entry numbers. When the
+// file is read, records for the entries which are not requested are
+// skipped without reading their bodies.
+//
+// Only one object at a time can write a given file, so that several
+// analyses run over the same input (for example, option variants) can
+// not overwrite each other's records. The files should be created and
+// destroyed in one thread.
+//
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cassert>
+
+class DerivedQuantitySidecar
+{
+public:
+    // Open the file for writing. Throws std::runtime_error
+    // if the file can not be open or is already being written.
+    static DerivedQuantitySidecar* create(const char* filename,
+                                          unsigned long long quantities,
+                                          unsigned long long configuration);
+
+    // Open the file for reading. Throws std::runtime_error
+    // if the file can not be open or has a wrong header.
+    static DerivedQuantitySidecar* open(const char* filename);
+
+    ~DerivedQuantitySidecar();
+
+    inline const std::string& filename() const {return filename_;}
+    inline bool isWritable() const {return writable_;}
+    inline unsigned long long quantities() const {return quantities_;}
+    inline unsigned long long configuration() const {return config_;}
+
+    // Write the record body for the given entry. Returns "false"
+    // if writing fails.
+    bool writeRecord(long long entry, const std::vector<char>& body);
+
+    // Read the record body for the given entry. Returns "false"
+    // if there is no record for this entry (all records for smaller
+    // entry numbers are skipped).
+    bool readRecord(long long entry, std::vector<char>* body);
+
+private:
+    DerivedQuantitySidecar(const char* filename, bool writable);
+    DerivedQuantitySidecar(const DerivedQuantitySidecar&);
+    DerivedQuantitySidecar& operator=(const DerivedQuantitySidecar&);
+
+    std::string filename_;
+    std::fstream stream_;
+    unsigned long long quantities_;
+    unsigned long long config_;
+    long long entry_;
+    bool writable_;
+};
+
+#endif // DerivedQuantitySidecar_h_
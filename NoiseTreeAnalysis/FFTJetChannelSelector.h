@@ -1,9 +1,13 @@
 #ifndef FFTJetChannelSelector_h_
 #define FFTJetChannelSelector_h_
 
+#include <memory>
+
 #include "AbsChannelSelector.h"
 #include "HBHEChannelGeometry.h"
+#include "HBHEChannelMap.h"
 #include "fftjetTypedefs.h"
+#include "FFTWUtils.h"
 
 #include "fftjet/Grid2d.hh"
 #include "fftjet/Kernels.hh"
@@ -14,23 +18,18 @@
 #include "fftjet/PeakSelectors.hh"
 #include "fftjet/GaussianNoiseMembershipFcn.hh"
 
+//
+// Base class which holds the reconstructed jets and associates
+// the channels with them. It does not depend on the precision
+// of the energy flow grid.
+//
 template <class AnalysisClass>
-class FFTJetChannelSelector : public AbsChannelSelector<AnalysisClass>
+class AbsFFTJetChannelSelector : public AbsChannelSelector<AnalysisClass>
 {
 public:
     typedef fftjet::RecombinedJet<VectorLike> Jet;
 
-    FFTJetChannelSelector(const HBHEChannelGeometry& geometry,
-                          unsigned nEtaBins, double etaMin, double etaMax,
-                          unsigned nPhiBins, double pattRecoScale,
-                          double etaToPhiBandwidthRatio, double coneSize,
-                          double peakEtCutoff, double jetPtCutoff);
-
-    inline virtual ~FFTJetChannelSelector() {}
-
-    virtual void select(const AnalysisClass& event,
-                        std::vector<unsigned char>* mask,
-                        std::vector<double>* associatedJetPt);
+    inline virtual ~AbsFFTJetChannelSelector() {}
 
     inline const std::vector<Jet>& getJets() const {return recoJets_;}
     inline const VectorLike& unclusteredP4() const {return unclustered_;}
@@ -38,31 +37,133 @@ public:
     inline double unusedEt() const {return unclusScalar_;}
     inline unsigned nGoodJets() const {return jetEta_.size();}
 
-private:
-    FFTJetChannelSelector();
+protected:
+    AbsFFTJetChannelSelector(const HBHEChannelGeometry& geometry,
+                             double etaToPhiBandwidthRatio, double coneSize,
+                             double jetPtCutoff);
+
+    // Sort the reconstructed jets by Pt and fill the arrays
+    // of jet Pt, eta, and phi. This also fills the "jetRank_"
+    // array which maps the original jet order into the sorted one.
+    void sortJets();
+
+    // Associate each channel with the closest jet inside the jet cone.
+    // Must be called after "sortJets".
+    void associateChannels(const AnalysisClass& event,
+                           std::vector<unsigned char>* mask,
+                           std::vector<double>* associatedJetPt) const;
 
     // Calorimeter geometry
     const HBHEChannelGeometry& geometry_;
 
     // Parameters specified in the constructor
-    double patRecoScale_;
     double jetPtCutoff_;
 
     // Cone sizes in eta and phi
     double etaConeSize_;
     double phiConeSize_;
 
+    // Channel directions and the factors for
+    // converting channel energy into Et
+    std::vector<double> chanEta_;
+    std::vector<double> chanPhi_;
+    std::vector<double> chanPerp_;
+
+    // The vector of reconstructed jets (we will refill it in every event)
+    std::vector<Jet> recoJets_;
+
+    // Jet pt, eta and phi for fast access
+    std::vector<double> jetPt_;
+    std::vector<double> jetEta_;
+    std::vector<double> jetPhi_;
+
+    // Position of each jet after sorting, indexed by the jet
+    // number assigned by the recombination algorithm
+    std::vector<unsigned> jetRank_;
+    std::vector<unsigned> sortOrder_;
+
+    // Unclustered 4-vector and unused transverse energy
+    VectorLike unclustered_;
+    double unclusScalar_;
+
+    // Total visible transverse energy, summed as scalar
+    double sumEt_;
+
+private:
+    AbsFFTJetChannelSelector();
+};
+
+//
+// The energy flow grid can be discretized in double (default) or
+// single precision. Single precision transforms are approximately
+// twice as fast.
+//
+// Each channel is mapped onto its grid cell once, in the constructor.
+// Only the cells which were filled in an event are cleared afterwards.
+//
+// If "useClusterMembership" is "true", the channels are associated with
+// the jets whose recombination algorithm clustered the channel grid
+// cells instead of the closest jet inside the jet cone.
+//
+// The FFT engine is shared by all selectors which use the same grid
+// size, precision, and planning flags, so that the FFTW plans are
+// made only once per program. Planning flags other than FFTW_ESTIMATE
+// are best used together with the wisdom utilities in "FFTWUtils.h".
+//
+template <class AnalysisClass, typename GridReal = Real>
+class FFTJetChannelSelector : public AbsFFTJetChannelSelector<AnalysisClass>
+{
+public:
+    typedef typename FFTWPrecision<GridReal>::Complex MyComplex;
+    typedef typename FFTWPrecision<GridReal>::Engine MyEngine;
+
+    FFTJetChannelSelector(const HBHEChannelGeometry& geometry,
+                          unsigned nEtaBins, double etaMin, double etaMax,
+                          unsigned nPhiBins, double pattRecoScale,
+                          double etaToPhiBandwidthRatio, double coneSize,
+                          double peakEtCutoff, double jetPtCutoff,
+                          unsigned fftwPlanningFlags = FFTW_ESTIMATE,
+                          bool useClusterMembership = false);
+
+    inline virtual ~FFTJetChannelSelector() {}
+
+    virtual void select(const AnalysisClass& event,
+                        std::vector<unsigned char>* mask,
+                        std::vector<double>* associatedJetPt);
+
+private:
+    FFTJetChannelSelector();
+
+    // Associate each channel with the jet to which
+    // its grid cell was assigned by the recombination algorithm
+    void associateMembers(const AnalysisClass& event,
+                          std::vector<unsigned char>* mask,
+                          std::vector<double>* associatedJetPt) const;
+
+    // Parameters specified in the constructor
+    double patRecoScale_;
+    bool useClusterMembership_;
+
     // Energy flow discretization grid
-    fftjet::Grid2d<Real> calo_;
+    fftjet::Grid2d<GridReal> calo_;
+
+    // Linear grid cell number for each channel (-1 if the channel
+    // is outside of the grid) and its eta and phi bin numbers
+    std::vector<int> chanCell_;
+    std::vector<unsigned> chanEtaBin_;
+    std::vector<unsigned> chanPhiBin_;
+
+    // Channels whose grid cells were filled in the current event
+    std::vector<unsigned> touchedChannels_;
 
     // The DFFT engine
-    MyFFTEngine engine_;
+    std::shared_ptr<MyEngine> engine_;
 
     // Pattern recognition convolution kernel
     fftjet::DiscreteGauss2d kernel_;
 
     // Convolver for the kernel
-    fftjet::FrequencyKernelConvolver<Real,Complex> convolver_;
+    fftjet::FrequencyKernelConvolver<GridReal,MyComplex> convolver_;
 
     // Peak finder
     fftjet::PeakFinder peakFinder_;
@@ -73,25 +174,10 @@ private:
     // Members needed to define the energy recombination algorithm
     fftjet::Linear2d jetMemberFcn_;
     fftjet::GaussianNoiseMembershipFcn noiseMemberFcn_;
-    fftjet::KernelRecombinationAlg<Real,VectorLike,BgData,VBuilder> recoAlg_;
+    fftjet::KernelRecombinationAlg<GridReal,VectorLike,BgData,VBuilder> recoAlg_;
 
     // FFTJet algorithm sequence
-    fftjet::ConstScaleReconstruction<Real,VectorLike,BgData> sequencer_;
-
-    // The vector of reconstructed jets (we will refill it in every event)
-    std::vector<Jet> recoJets_;
-
-    // Jet pt, eta and phi for fast access
-    std::vector<double> jetPt_;
-    std::vector<double> jetEta_;
-    std::vector<double> jetPhi_;
-
-    // Unclustered 4-vector and unused transverse energy
-    VectorLike unclustered_;
-    double unclusScalar_;
-
-    // Total visible transverse energy, summed as scalar
-    double sumEt_;
+    fftjet::ConstScaleReconstruction<GridReal,VectorLike,BgData> sequencer_;
 };
 
 #include "FFTJetChannelSelector.icc"
@@ -0,0 +1,126 @@
+#ifndef FFTWUtils_h_
+#define FFTWUtils_h_
+
+//
+// Utilities for managing FFTW plans used by FFTJet: conversion of
+// the planning rigor name into FFTW flags, wisdom persistence, and
+// a registry of FFT engines shared by all users of the same grid.
+//
+// FFTW keeps separate wisdom for double and single precision
+// transforms, so the wisdom functions are templated on the grid
+// precision. Importing and exporting wisdom is not thread-safe
+// (neither is FFTW planning in general).
+//
+
+#include <map>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#include "fftjetTypedefs.h"
+
+//
+// Valid rigor names are "estimate", "measure", "patient", and
+// "exhaustive". Planning with anything other than "estimate"
+// can take a long time unless the wisdom is already available.
+//
+inline unsigned fftwPlanningFlags(const std::string& rigor)
+{
+    if (rigor == "estimate")
+        return FFTW_ESTIMATE;
+    else if (rigor == "measure")
+        return FFTW_MEASURE;
+    else if (rigor == "patient")
+        return FFTW_PATIENT;
+    else if (rigor == "exhaustive")
+        return FFTW_EXHAUSTIVE;
+    else
+    {
+        std::ostringstream os;
+        os << "In fftwPlanningFlags: unsupported FFTW planning rigor \""
+           << rigor << '"';
+        throw std::invalid_argument(os.str());
+    }
+}
+
+//
+// The following functions return "true" on success. It is not
+// an error for the wisdom file to be absent on import.
+//
+template <typename GridReal>
+bool importFFTWWisdom(const std::string& filename);
+
+template <typename GridReal>
+bool exportFFTWWisdom(const std::string& filename);
+
+template <>
+inline bool importFFTWWisdom<double>(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f)
+        return false;
+    const int status = fftw_import_wisdom_from_file(f);
+    fclose(f);
+    return status;
+}
+
+template <>
+inline bool importFFTWWisdom<float>(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f)
+        return false;
+    const int status = fftwf_import_wisdom_from_file(f);
+    fclose(f);
+    return status;
+}
+
+template <>
+inline bool exportFFTWWisdom<double>(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f)
+        return false;
+    fftw_export_wisdom_to_file(f);
+    return fclose(f) == 0;
+}
+
+template <>
+inline bool exportFFTWWisdom<float>(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f)
+        return false;
+    fftwf_export_wisdom_to_file(f);
+    return fclose(f) == 0;
+}
+
+//
+// FFT engine for the given grid size and planning flags. The engine
+// is created (and the plans are made) on the first request only.
+// Subsequent requests with the same arguments return the same
+// engine, so that all selectors in the program share the plans.
+// The engines are kept alive until the program exits.
+//
+template <typename GridReal>
+std::shared_ptr<typename FFTWPrecision<GridReal>::Engine>
+sharedFFTWEngine(const unsigned nEta, const unsigned nPhi,
+                 const unsigned planningFlags)
+{
+    typedef typename FFTWPrecision<GridReal>::Engine Engine;
+    typedef std::tuple<unsigned,unsigned,unsigned> Key;
+
+    static std::map<Key, std::shared_ptr<Engine> > engines;
+
+    const Key key(nEta, nPhi, planningFlags);
+    std::shared_ptr<Engine>& engine(engines[key]);
+    if (!engine)
+        engine = std::shared_ptr<Engine>(
+            new Engine(nEta, nPhi, planningFlags));
+    return engine;
+}
+
+#endif // FFTWUtils_h_
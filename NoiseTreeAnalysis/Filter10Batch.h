@@ -0,0 +1,159 @@
+#ifndef Filter10Batch_h_
+#define Filter10Batch_h_
+
+//
+// Application of one or several Filter10 filters to many 10-element
+// signals at once (e.g., to all pulses of an event).
+//
+// The signals must be stored in the slice-major (transposed) layout:
+// element t of signal p is at position t*n + p, where n is the number
+// of signals. The outputs of filter k are stored in the same layout,
+// starting at position k*10*n.
+//
+// The boundary treatment is the same as in Filter10 (the signal is
+// extended by its first and last values). Since clamping depends only
+// on the time slice and not on the signal, each filter is converted
+// into a 10x10 matrix with the clamping folded in. Then the innermost
+// loops run over signals, without branches, and can be vectorized
+// by the compiler.
+//
+// Filter10Batch batch;
+// const unsigned k = batch.add(filter);
+// Filter10Batch::transpose(&charge[0][0], n, &chargeT[0]);
+// batch.apply(&chargeT[0], n, &filteredT[0]);
+//
+
+#include <vector>
+#include <cassert>
+
+#include "Filter10.h"
+
+class Filter10Batch
+{
+public:
+    inline Filter10Batch() {}
+
+    // Add a filter. Returns the number of the filter in the batch.
+    inline unsigned add(const Filter10& filter)
+    {
+        const unsigned k = nFilters();
+        weights_.resize((k + 1U)*100U, 0.0);
+        firstSlice_.resize((k + 1U)*10U);
+        endSlice_.resize((k + 1U)*10U);
+
+        const std::vector<double>& f = filter.filterData();
+        const int sz = f.size();
+        const int i0 = filter.filterStartTime();
+        for (int t=0; t<10; ++t)
+        {
+            double* w = &weights_[(k*10U + t)*10U];
+            for (int j=0; j<sz; ++j)
+            {
+                int i = t + i0 + j;
+                if (i < 0)
+                    i = 0;
+                else if (i > 9)
+                    i = 9;
+                w[i] += f[j];
+            }
+
+            // Remember the range of slices with nonzero weights
+            unsigned first = 0, end = 10;
+            while (first < end && w[first] == 0.0)
+                ++first;
+            while (end > first && w[end - 1U] == 0.0)
+                --end;
+            firstSlice_[k*10U + t] = first;
+            endSlice_[k*10U + t] = end;
+        }
+        return k;
+    }
+
+    inline unsigned nFilters() const {return weights_.size()/100U;}
+
+    // "in" must have 10*n elements and "out" 10*n*nFilters() elements
+    template<class Data>
+    inline void apply(const Data* in, const unsigned n, Data* out) const
+    {
+        if (!n)
+            return;
+        assert(in);
+        assert(out);
+
+        const unsigned nf = nFilters();
+        for (unsigned k=0; k<nf; ++k)
+            for (unsigned t=0; t<10U; ++t)
+            {
+                const double* w = &weights_[(k*10U + t)*10U];
+                const unsigned first = firstSlice_[k*10U + t];
+                const unsigned end = endSlice_[k*10U + t];
+                Data* o = out + (k*10U + t)*n;
+
+                if (first == end)
+                {
+                    for (unsigned p=0; p<n; ++p)
+                        o[p] = Data();
+                    continue;
+                }
+
+                const Data w0 = static_cast<Data>(w[first]);
+                const Data* src = in + first*n;
+                for (unsigned p=0; p<n; ++p)
+                    o[p] = w0*src[p];
+
+                for (unsigned i=first+1U; i<end; ++i)
+                {
+                    const Data wi = static_cast<Data>(w[i]);
+                    if (wi == Data())
+                        continue;
+                    src = in + i*n;
+                    for (unsigned p=0; p<n; ++p)
+                        o[p] += wi*src[p];
+                }
+            }
+    }
+
+    // Conversion from the signal-major layout (10 consecutive
+    // elements per signal, as in the ntuple) into the slice-major one
+    template<class Data>
+    static inline void transpose(const Data* in, const unsigned n, Data* out)
+    {
+        for (unsigned p=0; p<n; ++p)
+        {
+            const Data* s = in + p*10U;
+            for (unsigned t=0; t<10U; ++t)
+                out[t*n + p] = s[t];
+        }
+    }
+
+    // For every signal, find the first slice with the largest value.
+    // "in" is in the slice-major layout (e.g., the output of one filter).
+    template<class Data>
+    static inline void argmax(const Data* in, const unsigned n,
+                              Data* workBuf, unsigned* result)
+    {
+        for (unsigned p=0; p<n; ++p)
+        {
+            workBuf[p] = in[p];
+            result[p] = 0;
+        }
+        for (unsigned t=1; t<10U; ++t)
+        {
+            const Data* row = in + t*n;
+            for (unsigned p=0; p<n; ++p)
+            {
+                const bool larger = row[p] > workBuf[p];
+                workBuf[p] = larger ? row[p] : workBuf[p];
+                result[p] = larger ? t : result[p];
+            }
+        }
+    }
+
+private:
+    // 10x10 weight matrix for each filter: output slice, input slice
+    std::vector<double> weights_;
+    std::vector<unsigned> firstSlice_;
+    std::vector<unsigned> endSlice_;
+};
+
+#endif // Filter10Batch_h_
@@ -60,6 +60,13 @@ public:
     const std::vector<unsigned>& channelNeigborsFromOtherHPDs(
         unsigned channelNumber) const;
 
+    // Lookup the list of all channels geometrically neighboring
+    // the given channel, irrespective of their HPD. This includes
+    // the channels with adjacent ieta and/or iphi at the same depth
+    // (taking into account the coarser phi segmentation at high
+    // |ieta|) and the channels at other depths in the same tower.
+    const std::vector<unsigned>& channelNeighbors(unsigned channelNumber) const;
+
     // Fill unique neighbors for the given set of channels. This method
     // assumes that all input channels come from a single HPD.
     void channelSetNeighbors(const std::vector<unsigned>& input,
@@ -107,7 +114,11 @@ private:
     std::vector<unsigned> hpd_neighbors_[HcalHPDRBXMap::NUM_HPDS];
     bool hpdNeighborsFilled_;
 
+    std::vector<unsigned> all_neighbors_[ChannelCount];
+    bool allNeighborsFilled_;
+
     void calculateNeighborList(unsigned index, std::vector<unsigned>*) const;
+    void calculateAllNeighbors(unsigned index, std::vector<unsigned>*) const;
     void calculateHPDNeighbors(unsigned hpd, std::vector<unsigned>*) const;
 };
 
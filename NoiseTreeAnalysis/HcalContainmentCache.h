@@ -0,0 +1,37 @@
+#ifndef HcalContainmentCache_h_
+#define HcalContainmentCache_h_
+
+//
+// On-disk cache of pulse containment correction tables.
+//
+// The tables are stored in the given directory, one file per
+// configuration. The file name is made out of a 64-bit FNV-1a hash of
+// the pulse shape bins and of the correction parameters. The hashed
+// data is also written into the file and verified on reading, so that
+// hash collisions can not produce a wrong table.
+//
+// Files are written under a temporary name and then renamed, so that
+// several jobs sharing the same cache directory can not see partially
+// written tables.
+//
+
+#include <string>
+
+class HcalPulseShape;
+class HcalPulseContainmentCorrection;
+
+// Returns a new correction object (to be deleted by the caller).
+// The table is loaded from the cache if it is there, otherwise it is
+// computed and stored in the cache. If "cacheDirectory" is empty,
+// the table is simply computed. Problems with writing the cache
+// are not treated as errors: the computed table is still returned.
+HcalPulseContainmentCorrection* cachedContainmentCorrection(
+    const std::string& cacheDirectory, const HcalPulseShape& shape,
+    int nSamples, float phaseNS, float maxFracError);
+
+// The hash used to name the cache files
+unsigned long long containmentCorrectionHash(
+    const HcalPulseShape& shape, int nSamples,
+    float phaseNS, float maxFracError);
+
+#endif // HcalContainmentCache_h_
@@ -0,0 +1,76 @@
+#ifndef HcalHPDShapeGenerator_h_
+#define HcalHPDShapeGenerator_h_
+
+//
+// Fast generator of the HPD pulse shape family, intended for use inside
+// minimization loops which fit the shape parameters to the observed
+// time slice charges.
+//
+// The shape model and its discretization are the same as in
+// HcalPulseShapes::computeHPDShape: the scintillator decay (sum of three
+// exponentials) is convolved with the HPD drift and with the preamp
+// response, on 256 bins 1 ns wide. The differences are in how it is
+// calculated:
+//
+//   1) The exponentials are evaluated by recursion, with only
+//      a handful of "exp" calls per shape.
+//
+//   2) The triple convolution is performed as two consecutive
+//      single convolutions.
+//
+//   3) Work arrays are reused between calls, and the prefix sums
+//      of the output shape are built in a single pass.
+//
+// The intermediate normalizations of computeHPDShape cancel out in the
+// final normalization and are therefore skipped. The generated shapes
+// agree with those from HcalPulseShapes up to float rounding.
+//
+
+#include <vector>
+
+#include "HcalPulseShape.h"
+
+class HcalHPDShapeGenerator
+{
+public:
+    enum {
+        NBins = 256,
+        TimeSliceNS = 25
+    };
+
+    HcalHPDShapeGenerator();
+
+    // The arguments have the same meaning as the arguments
+    // of HcalPulseShapes::computeHPDShape:
+    //
+    //  ts1, ts2, ts3    -- scintillation decay time constants (ns)
+    //  thpd             -- HPD current collection drift time (ns)
+    //  tpre             -- preamp time constant (ns)
+    //  wd1, wd2, wd3    -- relative weights of the decay exponents
+    //
+    // All time constants must be positive and all weights
+    // non-negative, with at least one weight positive.
+    // Returns the generated shape.
+    const HcalPulseShape& generate(double ts1, double ts2, double ts3,
+                                   double thpd, double tpre,
+                                   double wd1, double wd2, double wd3);
+
+    // The shape made by the last call to "generate"
+    inline const HcalPulseShape& shape() const {return shape_;}
+
+    // Fractions of the pulse contained in "nSlices" consecutive
+    // 25 ns time slices, the first one starting at "tStart" ns
+    void timeSliceFractions(double tStart, double* fractions,
+                            unsigned nSlices) const;
+
+private:
+    HcalPulseShape shape_;
+
+    std::vector<double> decay_;
+    std::vector<double> drift_;
+    std::vector<double> preamp_;
+    std::vector<double> partial_;
+    std::vector<float> bins_;
+};
+
+#endif // HcalHPDShapeGenerator_h_
@@ -0,0 +1,63 @@
+#ifndef HcalPhaseContainmentTable_h_
+#define HcalPhaseContainmentTable_h_
+
+//
+// Pulse containment correction tabulated as a function of both
+// the reconstructed charge and the timing phase.
+//
+// The charge axis is uniform in log(fC) and covers the same domain
+// as HcalPulseContainmentCorrection. The phase axis is uniform in ns.
+// The table is stored as a single contiguous array (phase rows of charge
+// points), and the correction is obtained by bilinear interpolation.
+// Charges and phases outside of the table domain are clamped to its
+// boundaries.
+//
+// Each phase row is produced by an HcalPulseContainmentCorrection object
+// built for that phase, so the table reproduces the single-phase
+// corrections at the grid phases.
+//
+
+#include <vector>
+
+class HcalPulseShape;
+
+class HcalPhaseContainmentTable
+{
+public:
+    // Number of points in the charge direction
+    enum {NChargePoints = 1024};
+
+    // "nPhasePoints" must be at least 2 and "maxPhaseNS"
+    // must be larger than "minPhaseNS"
+    HcalPhaseContainmentTable(const HcalPulseShape& shape, int nSamples,
+                              double minPhaseNS, double maxPhaseNS,
+                              unsigned nPhasePoints, double maxFracError);
+
+    inline double minPhaseNS() const {return minPhase_;}
+    inline double maxPhaseNS() const {return maxPhase_;}
+    inline unsigned nPhasePoints() const {return nPhase_;}
+
+    // Correction for a single pulse
+    double getCorrection(double fc_ampl, double phaseNS) const;
+
+    // Corrections for n pulses, each with its own phase.
+    // The loop is written without branches so that it
+    // can be vectorized by the compiler.
+    void getCorrections(const float* fc_ampl, const float* phaseNS,
+                        float* corrections, unsigned n) const;
+
+private:
+    HcalPhaseContainmentTable();
+
+    std::vector<float> table_;
+    float minFC_;
+    float maxFC_;
+    float logMinFC_;
+    float invLogStep_;
+    float minPhase_;
+    float maxPhase_;
+    float invPhaseStep_;
+    unsigned nPhase_;
+};
+
+#endif // HcalPhaseContainmentTable_h_
@@ -2,6 +2,10 @@
 #define CALIBCALORIMETRY_HCALALGOS_HCALPULSECONTAINMENTCORRECTION_H 1
 
 #include <map>
+#include <vector>
+#include <iostream>
+
+#include "geners/ClassId.hh"
 
 class HcalPulseShape;
 
@@ -16,6 +20,9 @@ class HcalPulseShape;
   */
 class HcalPulseContainmentCorrection {
 public:
+  // Default constructor makes an empty object which
+  // is only useful as a target for "restore"
+  HcalPulseContainmentCorrection();
   HcalPulseContainmentCorrection(int num_samples,
                                  float fixedphase_ns,
                                  float max_fracerror);
@@ -23,11 +30,42 @@ public:
                                  int num_samples,
                                  float fixedphase_ns,
                                  float max_fracerror);
+  // The correction is linearly interpolated on a grid uniform in log(fC)
   double getCorrection(double fc_ampl) const;
   double fractionContained(double fc_ampl) const { return 1.0/this->getCorrection(fc_ampl); }
 
+  // Corrections for n amplitudes at once. Equivalent to calling
+  // getCorrection for each amplitude, but written so that the loop
+  // can be vectorized by the compiler.
+  void getCorrections(const float* fc_ampl, float* corrections, unsigned n) const;
+
+  // Nearest-neighbor lookup in the original map (the old behavior)
+  double getMapCorrection(double fc_ampl) const;
+
+  // Number of points in the interpolation grid
+  enum {NTablePoints = 1024};
+
+  // I/O methods needed for writing. Only the lookup map is
+  // written, the interpolation grid is rebuilt on reading.
+  inline gs::ClassId classId() const {return gs::ClassId(*this);}
+  bool write(std::ostream& of) const;
+
+  // I/O methods needed for reading
+  static inline const char* classname() {return "HcalPulseContainmentCorrection";}
+  static inline unsigned version() {return 1;}
+  static void restore(const gs::ClassId& id, std::istream& in,
+                      HcalPulseContainmentCorrection* ptr);
+
 private:
+  void buildTable();
+
   std::map<double,double> mCorFactors_;
+
+  std::vector<float> table_;
+  float minFC_;
+  float maxFC_;
+  float logMinFC_;
+  float invLogStep_;
 };
 
 #endif
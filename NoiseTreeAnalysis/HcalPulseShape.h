@@ -8,13 +8,27 @@ public:
   HcalPulseShape();
   void setNBin(int n);
   void setShapeBin(int i, float f);
+  // Set all bins at once. The prefix sums used by "integrate" are
+  // built right away, while after "setShapeBin" they are rebuilt
+  // on the next "integrate" call. Because of this, a shape filled
+  // with "setShapeBin" should be integrated once before it is
+  // shared among threads.
+  void setShape(const float* values, int n);
   float getTpeak() const { return tpeak_; }
   float operator()(double time) const;
   float at(double time) const;
   float integrate(double tmin, double tmax) const;
   int nbins() const {return nbin_;}
 private:
+  // Integral of "at" from -infinity up to t
+  double cumulative(double t) const;
+  void buildCumulative() const;
+
   std::vector<float> shape_;
+  // cum_[k] is the integral of "at" up to k-0.5 ns (for k > 0).
+  // Valid only if cumValid_ is true.
+  mutable std::vector<double> cum_;
+  mutable bool cumValid_;
   int nbin_;
   float tpeak_;
 };
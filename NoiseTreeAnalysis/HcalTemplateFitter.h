@@ -0,0 +1,103 @@
+#ifndef HcalTemplateFitter_h_
+#define HcalTemplateFitter_h_
+
+//
+// Template fit of the pulse amplitude and arrival time for HCAL pulses
+// sampled in 10 time slices 25 ns wide.
+//
+// The pulse template is made by integrating an HcalPulseShape over
+// the time slices. With zero time shift, the pulse starts at the
+// beginning of the "sample of interest" (SOI) slice. Positive shifts
+// delay the pulse. Optionally, the fit also includes an out-of-time
+// pulse which arrives one time slice earlier than the in-time pulse.
+//
+// The fit proceeds in two steps:
+//
+//   1) The time shift is scanned on a grid. For every grid point, the
+//      amplitudes are profiled out analytically, using precomputed
+//      inverse Gram matrices of the templates.
+//
+//   2) Starting from the best grid point, one linearized (Gauss-Newton)
+//      step is made for the time shift, using precomputed template
+//      derivatives.
+//
+// All pulses of an event are fitted together. The charges are
+// transposed into a slice-major (structure of arrays) layout, so that
+// the grid scan runs over pulses in its innermost loop. These loops
+// have no branches and can be vectorized by the compiler.
+//
+// All time slices are given equal weight in the fit.
+//
+// Note that, for wide ranges of time shifts, an in-time pulse plus
+// an out-of-time pulse can often be traded for a later in-time pulse
+// with a different out-of-time amplitude. When the out-of-time pulse
+// is fitted, the shift range should therefore be kept narrow.
+//
+
+#include <vector>
+
+class HcalPulseShape;
+
+class HcalTemplateFitter
+{
+public:
+    enum {
+        NSlices = 10,
+        SliceWidthNS = 25
+    };
+
+    // Time shifts are scanned from "minShiftNS" to "maxShiftNS"
+    // (inclusive) in steps of "shiftStepNS"
+    HcalTemplateFitter(const HcalPulseShape& shape, unsigned soi = 4,
+                       double minShiftNS = -25.0, double maxShiftNS = 25.0,
+                       double shiftStepNS = 0.5, bool fitOOTPulse = false);
+
+    inline unsigned soi() const {return soi_;}
+    inline bool fitsOOTPulse() const {return fitOOT_;}
+    inline unsigned nGridPoints() const {return nGrid_;}
+
+    // Fit "nPulses" pulses. "charges" and "pedestals" are arrays
+    // of nPulses*NSlices elements (one group of NSlices per pulse,
+    // as in the ntuple). "pedestals" can be NULL if the charges are
+    // already pedestal-subtracted. "ootAmplitudes" can be NULL.
+    // The residual sum of squares of each fit is stored in "chisq".
+    void fit(const double* charges, const double* pedestals,
+             unsigned nPulses, double* amplitudes, double* timeShifts,
+             double* ootAmplitudes, double* chisq);
+
+    // Template value for the given slice and time shift
+    // (grid point numbering)
+    double templateValue(unsigned gridPoint, unsigned slice) const;
+
+private:
+    HcalTemplateFitter();
+
+    // Number of basis functions in the refinement step
+    inline unsigned nBasis() const {return fitOOT_ ? 3U : 2U;}
+
+    unsigned soi_;
+    double minShift_;
+    double shiftStep_;
+    unsigned nGrid_;
+    bool fitOOT_;
+
+    // Per grid point arrays, NSlices elements per point
+    std::vector<double> template_;
+    std::vector<double> derivative_;
+    std::vector<double> ootTemplate_;
+
+    // Per grid point inverse Gram matrices for the scan
+    // (1 or 3 elements) and for the refinement (4 or 9 elements)
+    std::vector<double> scanInverse_;
+    std::vector<double> refineInverse_;
+
+    // Work buffers, reused between events
+    std::vector<double> q_;
+    std::vector<double> qq_;
+    std::vector<double> vf_;
+    std::vector<double> vg_;
+    std::vector<double> bestScore_;
+    std::vector<unsigned> bestPoint_;
+};
+
+#endif // HcalTemplateFitter_h_
@@ -24,6 +24,23 @@ public:
    number of fC will be delayed by the timeslew effect, for the
    specified bias setting. */
   static double delay(double fC, BiasSetting bias=Medium);
+
+  /** \brief Same as "delay" but uses a precomputed table instead of
+   calculating the logarithm. The table has TableBinsPerOctave points
+   per power of 2 in fC between 1 and 2^TableOctaves fC, and it is
+   linearly interpolated in fC. Outside of this range the delay is
+   saturated for all bias settings. The difference from "delay"
+   is below 1.e-4 ns. */
+  static double tabulatedDelay(double fC, BiasSetting bias=Medium);
+
+  /** \brief Tabulated delays for n amplitudes at once */
+  static void tabulatedDelays(const double* fC, double* delays,
+                              unsigned n, BiasSetting bias=Medium);
+
+  enum {
+    TableBinsPerOctave = 64,
+    TableOctaves = 13
+  };
 };
 
 #endif
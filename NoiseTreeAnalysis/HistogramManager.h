@@ -47,6 +47,7 @@
 #include <set>
 #include <map>
 #include <regex>
+#include <memory>
 
 #include "ManagedHisto.h"
 #include "TFile.h"
@@ -80,20 +81,23 @@ public:
     // informative message about non-processed requests to std::cerr)
     // is sufficient.
     //
+    // If "outputfile" is an empty string, no file is created. The
+    // managed items are then kept in memory only and deleted together
+    // with the manager. This is useful for analysis objects which only
+    // need to know what is requested (e.g., pipeline workers).
+    //
     HistogramManager(const std::string& outputfile,
                      const std::set<std::string>& histoTags);
 
-    inline virtual ~HistogramManager()
-        {if (outputfile_.IsOpen()) outputfile_.Write();}
+    virtual ~HistogramManager();
 
     // If you want to create a root histo not managed by this manager
     // but still saved into the same file, call the "cd" method before
     // creating it.
     inline void cd()
-        {outputfile_.cd();}
+        {cd(std::string());}
 
-    inline void cd(const std::string& dirname)
-        {findOrMakeDirectory(dirname)->cd();}
+    void cd(const std::string& dirname);
 
     // Check if the given tag is present in the set of "histoTags"
     // provided in the constructor. We will remember which checks
@@ -119,7 +123,17 @@ public:
     // different objects. Then you can group together all items
     // which require the same number of cycles. If "group" argument
     // is not provided, the default group will be used.
-    void manage(ManagedHisto* h, const char* group=0);
+    //
+    // The "dependencies" argument is a bit mask of derived quantities
+    // which the item's functors read. The meaning of the bits is up
+    // to the analysis code. The manager just collects the union of
+    // all masks, so that the analysis can skip calculating derived
+    // quantities nobody uses.
+    void manage(ManagedHisto* h, const char* group=0,
+                unsigned long dependencies=0UL);
+
+    // Union of the dependency masks of all managed items
+    inline unsigned long dependencies() const {return dependencies_;}
 
     // By default, methods "AutoFill" and "CycleFill" will throw
     // an exception if they are called on a non-existent group
@@ -152,12 +166,13 @@ private:
 
     TDirectory* findOrMakeDirectory(const std::string& dirname);
 
-    TFile outputfile_;
+    std::unique_ptr<TFile> outputfile_;
     std::set<std::string> requestedHistos_;
     std::set<std::string> checkedHistos_;
     std::vector<std::regex> requestedRegex_;
     ManagedHistoContainer histos_;
     Groups groups_;
+    unsigned long dependencies_;
 };
 
 #endif // HistogramManager_hh_
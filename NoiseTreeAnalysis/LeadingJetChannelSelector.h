@@ -1,13 +1,29 @@
 #ifndef LeadingJetChannelSelector_h_
 #define LeadingJetChannelSelector_h_
 
+#include <vector>
+
+#include "AbsChannelSelector.h"
+#include "HBHEChannelGeometry.h"
+#include "HBHEChannelMap.h"
+
 template <class AnalysisClass>
 class LeadingJetChannelSelector : public AbsChannelSelector<AnalysisClass>
 {
 public:
+    //
+    // If "useEtaPhiBuckets" is "true", the channels are distributed
+    // in the constructor among the cells of an eta-phi grid whose cell
+    // size matches the jet cone size. In every event, the cone of each
+    // jet is then rasterized onto this grid, and only the channels from
+    // the covered cells are examined. This produces exactly the same
+    // selection as the default exhaustive search over all channels
+    // and jets.
+    //
     LeadingJetChannelSelector(const HBHEChannelGeometry& geometry,
                               double coneSize, double etaToPhiBandwidthRatio,
-                              double hadronicPtCutoff);
+                              double hadronicPtCutoff,
+                              bool useEtaPhiBuckets = false);
 
     inline virtual ~LeadingJetChannelSelector() {}
 
@@ -17,6 +33,20 @@ public:
 private:
     LeadingJetChannelSelector();
 
+    // Fill out hadronic Pt, eta, and phi of the two leading jets.
+    // Returns the number of jets found.
+    unsigned getLeadingJets(const AnalysisClass& event, double* jetEta,
+                            double* jetPhi, double* jetPt) const;
+
+    // Associate channels with jets using exhaustive search
+    void associateAll(const AnalysisClass& event, const double* jetEta,
+                      const double* jetPhi, unsigned jetCount);
+
+    // Associate channels with jets using eta-phi buckets
+    void associateInCone(double jetEta, double jetPhi, int jetNumber);
+
+    void buildBuckets();
+
     // Calorimeter geometry
     const HBHEChannelGeometry& geometry_;
 
@@ -26,6 +56,29 @@ private:
     // Cone sizes in eta and phi
     double etaConeSize_;
     double phiConeSize_;
+
+    // Channel directions
+    std::vector<double> chanEta_;
+    std::vector<double> chanPhi_;
+
+    // Eta-phi bucket grid. Channel numbers for bucket "ib"
+    // are stored in "bucketChannels_" starting at position
+    // bucketStart_[ib] and ending just before bucketStart_[ib+1].
+    bool useBuckets_;
+    double bucketEtaMin_;
+    double bucketEtaWidth_;
+    double bucketPhiWidth_;
+    int nEtaBuckets_;
+    int nPhiBuckets_;
+    std::vector<unsigned> bucketStart_;
+    std::vector<unsigned> bucketChannels_;
+
+    // Jet associated with each channel (-1 if none) and the
+    // corresponding normalized squared distance. Only the entries
+    // listed in "touched_" differ from their default values.
+    int closestJet_[HBHEChannelMap::ChannelCount];
+    double closestDistance_[HBHEChannelMap::ChannelCount];
+    std::vector<unsigned> touched_;
 };
 
 #include "LeadingJetChannelSelector.icc"
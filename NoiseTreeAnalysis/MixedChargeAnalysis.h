@@ -20,6 +20,7 @@
 #include "AbsChannelSelector.h"
 #include "HBHEChannelGeometry.h"
 #include "JetSummary.h"
+#include "ChargeWindowSums.h"
 
 #include "geners/AbsArchive.hh"
 
@@ -192,6 +193,9 @@ private:
     // Charge reconstructed by the filter (up to this->PulseCount)
     double chargeReconstructed_[HBHEChannelMap::ChannelCount];
 
+    // Prefix sums of the channel charges, refilled after mixing
+    ChargeWindowSums chargeWindows_;
+
     // Summary for the locally reconstructed jets
     JetSummary jetSummary_;
 
@@ -48,11 +48,14 @@ struct MixedChargeAnalysisOptions
         : hbGeometryFile("Geometry/hb.ctr"),
           heGeometryFile("Geometry/he.ctr"),
           channelSelector("LeadingJetChannelSelector"),
+          fftwPlanning("estimate"),
           pattRecoScale(0.2),
           etaToPhiBandwidthRatio(1.0),
           coneSize(0.5),
           peakEtCutoff(5.0),
           jetPtCutoff(20.0),
+          clusterCellEtCutoff(0.5),
+          clusterSeedEtCutoff(2.0),
           chargeScaleFactor(1.0),
           minRecHitTime(-1.0e30),
           maxRecHitTime(1.0e30),
@@ -71,6 +74,9 @@ struct MixedChargeAnalysisOptions
     {
         mixExtraChannels = cmdline.has("-e", "--mixExtra");
         disableChargeMixing = cmdline.has(NULL, "--disableChargeMixing");
+        useEtaPhiBuckets = cmdline.has(NULL, "--useEtaPhiBuckets");
+        fftjetSinglePrecision = cmdline.has(NULL, "--fftjetSinglePrecision");
+        fftjetClusterMembership = cmdline.has(NULL, "--fftjetClusterMembership");
 
         if (disableChargeMixing)
         {
@@ -86,12 +92,16 @@ struct MixedChargeAnalysisOptions
         cmdline.option(NULL, "--hbgeo") >> hbGeometryFile;
         cmdline.option(NULL, "--hegeo") >> heGeometryFile;
         cmdline.option(NULL, "--channelSelector") >> channelSelector;
+        cmdline.option(NULL, "--fftwPlanning") >> fftwPlanning;
+        cmdline.option(NULL, "--fftwWisdom") >> fftwWisdom;
 
         cmdline.option(NULL, "--pattRecoScale") >> pattRecoScale;
         cmdline.option(NULL, "--etaToPhiBandwidthRatio") >> etaToPhiBandwidthRatio;
         cmdline.option(NULL, "--coneSize") >> coneSize;
         cmdline.option(NULL, "--peakEtCutoff") >> peakEtCutoff;
         cmdline.option(NULL, "--jetPtCutoff") >> jetPtCutoff;
+        cmdline.option(NULL, "--clusterCellEtCutoff") >> clusterCellEtCutoff;
+        cmdline.option(NULL, "--clusterSeedEtCutoff") >> clusterSeedEtCutoff;
         cmdline.option(NULL, "--chargeScaleFactor") >> chargeScaleFactor;
         cmdline.option(NULL, "--minRecHitTime") >> minRecHitTime;
         cmdline.option(NULL, "--maxRecHitTime") >> maxRecHitTime;
@@ -118,11 +128,18 @@ struct MixedChargeAnalysisOptions
            << " [--hbgeo filename]"
            << " [--hegeo filename]"
            << " [--channelSelector classname]"
+           << " [--useEtaPhiBuckets]"
+           << " [--fftjetSinglePrecision]"
+           << " [--fftjetClusterMembership]"
+           << " [--fftwPlanning rigor]"
+           << " [--fftwWisdom filename]"
            << " [--pattRecoScale value]"
            << " [--etaToPhiBandwidthRatio value]"
            << " [--coneSize value]"
            << " [--peakEtCutoff value]"
            << " [--jetPtCutoff value]"
+           << " [--clusterCellEtCutoff value]"
+           << " [--clusterSeedEtCutoff value]"
            << " [--chargeScaleFactor value]"
            << " [--minRecHitTime value]"
            << " [--maxRecHitTime value]"
@@ -171,8 +188,26 @@ struct MixedChargeAnalysisOptions
            << "                     archive is created.\n\n";
         os << " --channelSelector   Class to use for selecting good channels. Valid\n"
               "                     values of this option are \"FFTJetChannelSelector\",\n"
-              "                     \"LeadingJetChannelSelector\", and \"AllChannelSelector\".\n"
+              "                     \"LeadingJetChannelSelector\", \"ClusterChannelSelector\",\n"
+              "                     and \"AllChannelSelector\".\n"
               "                     Default is \"LeadingJetChannelSelector\".\n\n";
+        os << " --useEtaPhiBuckets  Speed up \"LeadingJetChannelSelector\" by looking up\n"
+           << "                     the channels inside the jet cones on a precomputed\n"
+           << "                     eta-phi grid instead of checking every channel.\n"
+           << "                     The channel selection is not affected.\n\n";
+        os << " --fftjetSinglePrecision  Discretize the energy flow and perform the FFTJet\n"
+           << "                     convolutions in single precision (faster).\n\n";
+        os << " --fftjetClusterMembership  Associate channels with the FFTJet jets which\n"
+           << "                     clustered their grid cells instead of the closest jets\n"
+           << "                     within the jet cone.\n\n";
+        os << " --fftwPlanning      FFTW planning rigor for FFTJet. Valid values of this\n"
+           << "                     option are \"estimate\", \"measure\", \"patient\", and\n"
+           << "                     \"exhaustive\". Default is \"estimate\". Planning with\n"
+           << "                     higher rigor is slow unless the FFTW wisdom is available.\n\n";
+        os << " --fftwWisdom        File for FFTW wisdom. The wisdom is loaded from this file\n"
+           << "                     (if it exists) before the FFTW plans are made, and saved\n"
+           << "                     into it afterwards. Single and double precision wisdom\n"
+           << "                     should be kept in different files.\n\n";
         os << " --pattRecoScale     Pattern recognition scale for FFTJet jet reconstruction.\n"
            << "                     Default value is 0.2.\n\n";
         os << " --etaToPhiBandwidthRatio   Eta/phi pattern recognition bandwidth ratio and\n"
@@ -182,7 +217,12 @@ struct MixedChargeAnalysisOptions
         os << " --peakEtCutoff      Peak magnitude cutoff (local Et) for jet reconstruction.\n"
            << "                     Default is 5.0.\n\n";
         os << " --jetPtCutoff       Minimum transverse momentum for \"good\" jets. Default\n"
-           << "                     value is 20.0.\n\n";
+           << "                     value is 20.0. \"ClusterChannelSelector\" uses this\n"
+           << "                     cutoff for the cluster Et.\n\n";
+        os << " --clusterCellEtCutoff  Minimum channel Et for inclusion into clusters made\n"
+           << "                     by \"ClusterChannelSelector\". Default is 0.5.\n\n";
+        os << " --clusterSeedEtCutoff  Minimum Et of at least one channel in a cluster made\n"
+           << "                     by \"ClusterChannelSelector\". Default is 2.0.\n\n";
         os << " --chargeScaleFactor Charge scale factor for mixed events. Default is 1.0.\n\n";
         os << " --minRecHitTime     Minimum RecHitTime for \"good\" channels. Default is\n"
            << "                     a negative number of large magnitude (all channels pass).\n\n";
@@ -214,12 +254,16 @@ struct MixedChargeAnalysisOptions
     std::string filterFile;
     std::string channelArchive;
     std::string channelSelector;
+    std::string fftwPlanning;
+    std::string fftwWisdom;
 
     double pattRecoScale;
     double etaToPhiBandwidthRatio;
     double coneSize;
     double peakEtCutoff;
     double jetPtCutoff;
+    double clusterCellEtCutoff;
+    double clusterSeedEtCutoff;
     double chargeScaleFactor;
     double minRecHitTime;
     double maxRecHitTime;
@@ -234,6 +278,9 @@ struct MixedChargeAnalysisOptions
     unsigned maxPostTS;
     bool mixExtraChannels;
     bool disableChargeMixing;
+    bool useEtaPhiBuckets;
+    bool fftjetSinglePrecision;
+    bool fftjetClusterMembership;
 };
 
 std::ostream& operator<<(std::ostream& os, const MixedChargeAnalysisOptions& o)
@@ -245,11 +292,15 @@ std::ostream& operator<<(std::ostream& os, const MixedChargeAnalysisOptions& o)
        << ", filterFile = \"" << o.filterFile << '"'
        << ", channelArchive = \"" << o.channelArchive << '"'
        << ", channelSelector = \"" << o.channelSelector << '"'
+       << ", fftwPlanning = \"" << o.fftwPlanning << '"'
+       << ", fftwWisdom = \"" << o.fftwWisdom << '"'
        << ", pattRecoScale = \"" << o.pattRecoScale << '"'
        << ", etaToPhiBandwidthRatio = \"" << o.etaToPhiBandwidthRatio << '"'
        << ", coneSize = \"" << o.coneSize << '"'
        << ", peakEtCutoff = \"" << o.peakEtCutoff << '"'
        << ", jetPtCutoff = \"" << o.jetPtCutoff << '"'
+       << ", clusterCellEtCutoff = \"" << o.clusterCellEtCutoff << '"'
+       << ", clusterSeedEtCutoff = \"" << o.clusterSeedEtCutoff << '"'
        << ", chargeScaleFactor = \"" << o.chargeScaleFactor << '"'
        << ", minRecHitTime = \"" << o.minRecHitTime << '"'
        << ", maxRecHitTime = \"" << o.maxRecHitTime << '"'
@@ -263,6 +314,9 @@ std::ostream& operator<<(std::ostream& os, const MixedChargeAnalysisOptions& o)
        << ", maxPostTS = " << o.maxPostTS
        << ", mixExtraChannels = " << o.mixExtraChannels
        << ", disableChargeMixing = " << o.disableChargeMixing
+       << ", useEtaPhiBuckets = " << o.useEtaPhiBuckets
+       << ", fftjetSinglePrecision = " << o.fftjetSinglePrecision
+       << ", fftjetClusterMembership = " << o.fftjetClusterMembership
         ;
     return os;
 }
@@ -23,8 +23,10 @@
 //
 
 #include <memory>
+#include <algorithm>
 
 #include "EventChargeInfo.h"
+#include "TouchedIndexList.h"
 
 class MixedChargeInfo
 {
@@ -95,6 +97,9 @@ public:
 private:
     MixedChargeInfo();
 
+    // Channels with added charge, in the order of addition
+    TouchedIndexList touchedChannels_;
+
     int centralTimeSlice_;
     bool mixExtraChannels_;
 };
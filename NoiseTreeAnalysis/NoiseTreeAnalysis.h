@@ -7,6 +7,17 @@
 #include "HBHEChannelGeometry.h"
 #include "ChannelGroupInfo.h"
 #include "HcalPulseContainmentCorrection.h"
+#include "HcalPhaseContainmentTable.h"
+#include "HcalTemplateFitter.h"
+#include "Filter10Batch.h"
+#include "ChargeWindowSums.h"
+#include "ChannelGroupAccumulator.h"
+#include "OccupancyConverterBank.h"
+#include "TouchedIndexList.h"
+#include "SharedChannelIndex.h"
+#include "DerivedQuantitySidecar.h"
+#include "DerivedQuantityRecord.h"
+#include "AlignedArena.h"
 
 #include "npstat/stat/LeftCensoredDistribution.hh"
 
@@ -26,23 +37,52 @@ public:
                       unsigned long maxEvents, bool verbose,
                       const Options& opt);
 
-    virtual ~NoiseTreeAnalysis() {delete corr_;}
+    virtual ~NoiseTreeAnalysis()
+        {
+            delete sidecarOut_; delete sidecarIn_;
+            delete converterBank_; delete neighborGroups_; delete hpdGroups_;
+            delete templateFitter_; delete phaseCorr_; delete corr_;
+        }
 
     inline const Options& getOptions() const {return options_;}
     inline bool isVerbose() const {return verbose_;}
 
     virtual Bool_t Notify();
     virtual Int_t Cut(Long64_t entryNumber);
+    virtual bool supportsPipeline() const {return true;}
 
 protected:
     virtual int beginJob();
     virtual int event(Long64_t entryNumber);
     virtual int endJob();
 
+    // Pipelined processing (see RootChainPipeline.h). The record
+    // has the same layout as the sidecar file records.
+    virtual int computeEvent(Long64_t entryNumber, std::vector<char>* record);
+    virtual int fillEvent(Long64_t entryNumber, const std::vector<char>& record);
+
     virtual void bookManagedHistograms();
     virtual void fillManagedHistograms();
 
 private:
+    // Derived quantities which are calculated only when some booked
+    // histogram or ntuple needs them. Each managed item declares the
+    // quantities it reads when it is given to the histogram manager.
+    enum {
+        DQ_PulseSums = 1UL,       // chargeSums_, pedSums_, integSums_,
+                                  // integPeds_, signalFraction_, q45_
+        DQ_StartTimes = 2UL,      // startingSlice_, filterSums_
+        DQ_UncorrectedE = 4UL,    // uncorrectedE_
+        DQ_TemplateFit = 8UL,     // fitAmplitude_, etc.
+        DQ_HPDGroups = 16UL,      // hpdInfo_, staticNeighborInfo_
+        DQ_DynamicGroups = 32UL,  // hpdNeighbors_, dynamicNeighborInfo_
+        DQ_PseudoLogli = 64UL,    // pulseLogli_
+        DQ_RawCharge = 128UL      // this->Charge, this->Pedestal used directly
+    };
+
+    // Add the quantities needed to calculate the given ones
+    static unsigned long dependencyClosure(unsigned long quantities);
+
     // Options passed to us from the main program
     const Options options_;
     const bool verbose_;
@@ -56,42 +96,102 @@ private:
     // HCAL geometry tool
     HBHEChannelGeometry channelGeometry_;
 
+    // Per-event working arrays, kept together in one cache line
+    // aligned block. Per-pulse arrays are used up to this->PulseCount,
+    // so that the event working set scales with the number of pulses.
+    // Quantities which end up only in float ntuple columns are stored
+    // as floats. The channel count is a multiple of the cache line size,
+    // so each array starts at a cache line boundary.
+    struct WorkArrays
+    {
+        // Per pulse
+        unsigned channelNumber[HBHEChannelMap::ChannelCount];
+        unsigned hpdNumber[HBHEChannelMap::ChannelCount];
+        unsigned chanInHpdNumber[HBHEChannelMap::ChannelCount];
+        unsigned rbxNumber[HBHEChannelMap::ChannelCount];
+        unsigned chanInRbxNumber[HBHEChannelMap::ChannelCount];
+        double chargeSums[HBHEChannelMap::ChannelCount];
+        double pedSums[HBHEChannelMap::ChannelCount];
+        float integSums[HBHEChannelMap::ChannelCount];
+        float integPeds[HBHEChannelMap::ChannelCount];
+        float signalFraction[HBHEChannelMap::ChannelCount];
+        float q45[HBHEChannelMap::ChannelCount];
+        float containmentCorr[HBHEChannelMap::ChannelCount];
+        float pulsePhase[HBHEChannelMap::ChannelCount];
+        unsigned startingSlice[HBHEChannelMap::ChannelCount];
+        double filterSums[HBHEChannelMap::ChannelCount];
+        float uncorrectedE[HBHEChannelMap::ChannelCount];
+        double fitAmplitude[HBHEChannelMap::ChannelCount];
+        double fitTimeShift[HBHEChannelMap::ChannelCount];
+        double fitOOTAmplitude[HBHEChannelMap::ChannelCount];
+        double fitChisq[HBHEChannelMap::ChannelCount];
+        double pulseLogli[HBHEChannelMap::ChannelCount];
+
+        // Per channel
+        int pulseNumber[HBHEChannelMap::ChannelCount];
+        float channelPhase[HBHEChannelMap::ChannelCount];
+        bool visibleChannel[HBHEChannelMap::ChannelCount];
+    };
+    static_assert(HBHEChannelMap::ChannelCount % 64U == 0U,
+                  "channel arrays must fill whole cache lines");
+
+    AlignedArena<WorkArrays> arena_;
+
+    // The members below point into the arena
+
     // Linearized channel number (index valid up to this->PulseCount)
-    unsigned channelNumber_[HBHEChannelMap::ChannelCount];
+    unsigned* const channelNumber_;
 
     // Lookup table from channel number into the sequence in this
     // tree. Filled with -1 if the channel was not read out.
-    int pulseNumber_[HBHEChannelMap::ChannelCount];
+    int* const pulseNumber_;
 
     // HPD and RBX numbers for this channel (up to this->PulseCount)
-    unsigned hpdNumber_[HBHEChannelMap::ChannelCount];
-    unsigned chanInHpdNumber_[HBHEChannelMap::ChannelCount];
-    unsigned rbxNumber_[HBHEChannelMap::ChannelCount];
-    unsigned chanInRbxNumber_[HBHEChannelMap::ChannelCount];
+    unsigned* const hpdNumber_;
+    unsigned* const chanInHpdNumber_;
+    unsigned* const rbxNumber_;
+    unsigned* const chanInRbxNumber_;
 
     // Total charge and pedestal in 10 time slices (up to this->PulseCount)
-    double chargeSums_[HBHEChannelMap::ChannelCount];
-    double pedSums_[HBHEChannelMap::ChannelCount];
+    double* const chargeSums_;
+    double* const pedSums_;
 
     // Charge and pedestal integrated over selected time slices
     // (with index valid up to this->PulseCount)
-    double integSums_[HBHEChannelMap::ChannelCount];
-    double integPeds_[HBHEChannelMap::ChannelCount];
+    float* const integSums_;
+    float* const integPeds_;
 
     // Ratio of the charge inside selected time window
     // to the total charge (up to this->PulseCount)
-    double signalFraction_[HBHEChannelMap::ChannelCount];
+    float* const signalFraction_;
 
     // Determine the time slice where the signal starts (up to this->PulseCount)
-    unsigned startingSlice_[HBHEChannelMap::ChannelCount];
+    unsigned* const startingSlice_;
 
     // Charge in the time slices determined by the filter
     // (up to this->PulseCount)
-    double filterSums_[HBHEChannelMap::ChannelCount];
+    double* const filterSums_;
 
     // "Uncorrected" energy with pulse containment correction removed
     // (up to this->PulseCount)
-    double uncorrectedE_[HBHEChannelMap::ChannelCount];
+    float* const uncorrectedE_;
+
+    // Charge in time slices 4 and 5 and the corresponding pulse
+    // containment corrections (up to this->PulseCount)
+    float* const q45_;
+    float* const containmentCorr_;
+
+    // Timing phases for the pulse containment correction, per channel
+    // and per pulse. Used only if the channel phase file is provided.
+    float* const channelPhase_;
+    float* const pulsePhase_;
+
+    // Template fit results (up to this->PulseCount). Calculated
+    // only if the template fit ntuple is requested.
+    double* const fitAmplitude_;
+    double* const fitTimeShift_;
+    double* const fitOOTAmplitude_;
+    double* const fitChisq_;
 
     // Summary info for channels grouped by HPDs
     ChannelGroupInfo hpdInfo_[HcalHPDRBXMap::NUM_HPDS];
@@ -107,26 +207,114 @@ private:
     // Channel numbers read out for each HPD in this event
     std::vector<unsigned> hpdChannelsReadOut_[HcalHPDRBXMap::NUM_HPDS];
 
-    // "Dynamic" neighbor channels for each HPD in this event
+    // "Dynamic" neighbor channels for each HPD in this event. These
+    // vectors and the ones above get their full capacity in "beginJob",
+    // so they are never reallocated while the events are processed.
     std::vector<unsigned> hpdNeighbors_[HcalHPDRBXMap::NUM_HPDS];
 
+    // Single-pass accumulators for "hpdInfo_" and "staticNeighborInfo_"
+    ChannelGroupAccumulator* hpdGroups_;
+    ChannelGroupAccumulator* neighborGroups_;
+
     // Channel occupancy per RBX
     double rbxOccupancy_[HcalHPDRBXMap::NUM_RBXS];
 
+    // Channels, HPDs, and RBXs with pulses in this event. Used
+    // to reset the per-event arrays above at the next event.
+    TouchedIndexList touchedChannels_;
+    TouchedIndexList touchedHpds_;
+    TouchedIndexList touchedRbxs_;
+
     // Table of distributions which convert energy values seen
     // into occupancy above that energy and back
     typedef std::shared_ptr<npstat::LeftCensoredDistribution> OccConverterPtr;
     std::vector<OccConverterPtr> occupancyConverters_;
 
+    // The same converters loaded from the compact bank file
+    OccupancyConverterBank* converterBank_;
+
+    // Channels for which the converters have nonzero visible fraction,
+    // optional tables of the channel contributions into the pseudo
+    // loglikelihood (options_.logliTableSize points per channel),
+    // and the contributions of all pulses in this event (up to
+    // this->PulseCount)
+    bool* const visibleChannel_;
+    std::vector<double> logliTable_;
+    double* const pulseLogli_;
+
+    // Filter for determining the start time of the pulse, also
+    // in the form applicable to all pulses of an event at once
+    Filter10 startTimeFilter_;
+    Filter10Batch startTimeBatch_;
+
+    // Charges of all pulses in the slice-major layout, their filtered
+    // values, and the work buffer for finding the filter maxima
+    std::vector<double> chargeT_;
+    std::vector<double> filteredT_;
+    std::vector<double> filterMax_;
+
+    // Prefix sums of charges and pedestals for all pulses
+    ChargeWindowSums chargeWindows_;
+    ChargeWindowSums pedWindows_;
+
     // Pulse containment correction
     HcalPulseContainmentCorrection* corr_;
 
+    // Pulse containment correction for per-channel phases
+    HcalPhaseContainmentTable* phaseCorr_;
+
+    // Template fit of the channel pulses
+    HcalTemplateFitter* templateFitter_;
+
+    // Derived quantities to calculate in every event
+    unsigned long derived_;
+
+    // Files from which the derived quantities are read instead of
+    // being calculated, or into which they are written. Only one
+    // of these can be open.
+    DerivedQuantitySidecar* sidecarIn_;
+    DerivedQuantitySidecar* sidecarOut_;
+
+    // Groups restored from the input sidecar in the last event.
+    // HPD and static neighbor groups are reset in the next event.
+    std::vector<unsigned> restoredHpds_;
+    std::vector<unsigned> restoredNeighbors_;
+    std::vector<unsigned> restoredDynamic_;
+
+    // Buffer for the sidecar file records
+    std::vector<char> sidecarRecord_;
+
+    // Channel number lookup used instead of the shared
+    // one when this object is a pipeline worker
+    SharedChannelIndex workerChannelIndex_;
+
     // Internal helper functions
     void loadOccupancyConverters();
+    void loadChannelPhases(const HcalPulseShape& shape);
+
+    unsigned long storableQuantities() const;
+    unsigned long long sidecarConfiguration() const;
+    void openSidecars();
+    void writeSidecarRecord(Long64_t chainEntry,
+                            const std::vector<char>& record);
+    void readSidecarRecord(Long64_t chainEntry);
+
+    // Calculate the derived quantities listed in "compute" (together
+    // with the per-event channel, HPD, and RBX lookups), and transfer
+    // the quantities listed in "q" to/from a record
+    void calculateQuantities(Long64_t entryNumber, unsigned long compute);
+    void writeDerivedQuantities(unsigned long q,
+                                std::vector<char>* record) const;
+    void readDerivedQuantities(unsigned long q,
+                               const std::vector<char>& record);
 
     double hpdDeltaPhiWithMET(unsigned hpd) const;
     double hpdMETRemainder(unsigned hpd) const;
 
+    inline bool haveOccupancyConverters() const
+        {return converterBank_ || !occupancyConverters_.empty();}
+    double channelLogContribution(unsigned channel, double energy) const;
+    void calculatePulseLogContributions();
     double calculatePseudoLogLikelihood(const std::vector<unsigned>& ch) const;
 
     double staticSignalPseudoLogli(const unsigned hpd) const
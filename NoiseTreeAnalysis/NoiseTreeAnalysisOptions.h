@@ -48,44 +48,78 @@ struct NoiseTreeAnalysisOptions
         : hbGeometryFile("Geometry/hb.ctr"),
           heGeometryFile("Geometry/he.ctr"),
           maxLogContribution(10.0),
+          logliTableMinE(0.1),
+          logliTableMaxE(1000.0),
           correctionPhaseNS(6.0),
           nPhiBins(144),
           minTSlice(4),
           maxTSlice(6),
-          hpdShapeNumber(105)
+          logliTableSize(0),
+          hpdShapeNumber(105),
+          templateFitOOT(false)
     {
     }
 
     void parse(CmdLine& cmdline)
     {
         cmdline.option(NULL, "--converters") >> convertersGSSAFile;
+        cmdline.option(NULL, "--converterBank") >> converterBankFile;
         cmdline.option(NULL, "--hbgeo") >> hbGeometryFile;
         cmdline.option(NULL, "--hegeo") >> heGeometryFile;
         cmdline.option(NULL, "--maxLogContribution") >> maxLogContribution;
+        cmdline.option(NULL, "--logliTableSize") >> logliTableSize;
+        cmdline.option(NULL, "--logliTableMinE") >> logliTableMinE;
+        cmdline.option(NULL, "--logliTableMaxE") >> logliTableMaxE;
         cmdline.option(NULL, "--correctionPhaseNS") >> correctionPhaseNS;
         cmdline.option(NULL, "--nPhiBins") >> nPhiBins;
         cmdline.option(NULL, "--minTSlice") >> minTSlice;
         cmdline.option(NULL, "--maxTSlice") >> maxTSlice;
         cmdline.option(NULL, "--hpdShapeNumber") >> hpdShapeNumber;
+        cmdline.option(NULL, "--containmentCache") >> containmentCacheDir;
+        cmdline.option(NULL, "--channelPhases") >> channelPhasesFile;
+        cmdline.option(NULL, "--writeSidecar") >> writeSidecarFile;
+        cmdline.option(NULL, "--readSidecar") >> readSidecarFile;
+        templateFitOOT = cmdline.has(NULL, "--templateFitOOT");
+
+        if (!convertersGSSAFile.empty() && !converterBankFile.empty())
+            throw CmdLineError("Options --converters and --converterBank "
+                               "can not be used together");
+        if (!writeSidecarFile.empty() && !readSidecarFile.empty())
+            throw CmdLineError("Options --writeSidecar and --readSidecar "
+                               "can not be used together");
 
         validateRangeLELT(minTSlice, "minTSlice", 0U, 9U);
         validateRangeLELT(maxTSlice, "maxTSlice", minTSlice+1U, 10U);
 
         if (maxLogContribution < 0.0)
             throw CmdLineError("Invalid specification for maxLogContribution");
+        if (logliTableSize == 1U)
+            throw CmdLineError("Invalid specification for logliTableSize");
+        if (logliTableSize && !(logliTableMinE > 0.0 &&
+                                logliTableMaxE > logliTableMinE))
+            throw CmdLineError("Invalid pseudo loglikelihood table energy range");
     }
 
     void listOptions(std::ostream& os) const
     {
         os << "[--converters converterFile]"
+           << " [--converterBank filename]"
            << " [--hbgeo filename]"
            << " [--hegeo filename]"
            << " [--maxLogContribution value]"
+           << " [--logliTableSize nPoints]"
+           << " [--logliTableMinE value]"
+           << " [--logliTableMaxE value]"
            << " [--correctionPhaseNS value]"
            << " [--nPhiBins nBins]"
            << " [--minTSlice tSlice]"
            << " [--maxTSlice tSlice]"
            << " [--hpdShapeNumber value]"
+           << " [--containmentCache directory]"
+           << " [--channelPhases filename]"
+           << " [--writeSidecar filename]"
+           << " [--readSidecar filename]"
+           << " [--templateFitOOT]"
             ;
     }
 
@@ -95,6 +129,11 @@ struct NoiseTreeAnalysisOptions
            << "                         the functions that convert observed energy into\n"
            << "                         p-values. This file should normally be produced by\n"
            << "                         the \"analyzeEChanNtuple\" executable.\n\n";
+        os << " --converterBank         Binary file with the same converters for all channels\n"
+           << "                         in a compact format, written by \"analyzeEChanNtuple\"\n"
+           << "                         with the \"-b\" option. Loads much faster than the\n"
+           << "                         \"--converters\" archive. Only one of these two options\n"
+           << "                         can be used.\n\n";
         os << " --hbgeo                 File containing HB geometry description. The default\n"
            << "                         value of this option is \"Geometry/hb.ctr\". If this\n"
            << "                         value is incorrect (i.e., if the program is run from\n"
@@ -108,6 +147,14 @@ struct NoiseTreeAnalysisOptions
         os << " --maxLogContribution    Maximum contribution (by modulus) a channel can make\n"
            << "                         into the energy-based pseudo loglikelihood of a group\n"
            << "                         of channels. Default value of this option is 10.0.\n\n";
+        os << " --logliTableSize        Number of points in the per-channel tables of the\n"
+           << "                         pseudo loglikelihood contributions. The tables are\n"
+           << "                         built from the converters on a grid equidistant in\n"
+           << "                         log(energy) and interpolated linearly. Default is 0\n"
+           << "                         which means that the converters are used directly.\n\n";
+        os << " --logliTableMinE        Energy range of the pseudo loglikelihood tables, in\n"
+           << " --logliTableMaxE        GeV. Energies outside of this range are handled by the\n"
+           << "                         converters directly. Defaults are 0.1 and 1000.0.\n\n";
         os << " --correctionPhaseNS     The value, in nanoseconds, of the \"phase\" parameter\n"
            << "                         for the energy pulse shape correction. Default value\n"
            << "                         of this option is 6.0.\n\n";
@@ -119,33 +166,78 @@ struct NoiseTreeAnalysisOptions
            << "                         determination. Default is 6.\n\n";
         os << " --hpdShapeNumber        \"Pulse shape number\" for the energy pulse shape\n"
            << "                         correction. Default value of this option is 105.\n\n";
+        os << " --containmentCache      Directory for caching the pulse containment correction\n"
+           << "                         tables between jobs. The directory must exist. By\n"
+           << "                         default, the tables are recalculated in every job.\n\n";
+        os << " --channelPhases         Text file with per-channel timing phase offsets, in\n"
+           << "                         nanoseconds, for the pulse containment correction.\n"
+           << "                         Each line contains a linear channel number and the\n"
+           << "                         offset added to \"correctionPhaseNS\" for that channel.\n"
+           << "                         Channels not listed get zero offset. By default, all\n"
+           << "                         channels use the same phase.\n\n";
+        os << " --writeSidecar          Binary file into which the per-event derived\n"
+           << "                         quantities (pulse charge sums, starting time slices,\n"
+           << "                         HPD summaries, etc) will be written. Only the\n"
+           << "                         quantities needed by the requested histograms and\n"
+           << "                         ntuples are written. Option variants run over the\n"
+           << "                         same input must use different files.\n\n";
+        os << " --readSidecar           Binary file, written with \"--writeSidecar\" by an\n"
+           << "                         earlier job over the same input, from which the\n"
+           << "                         derived quantities will be read instead of being\n"
+           << "                         recalculated. Unless some requested ntuple needs\n"
+           << "                         them, the charge and pedestal branches of the input\n"
+           << "                         tree are not read (this is not done if other\n"
+           << "                         analyses or option variants are run over the same\n"
+           << "                         read of the input).\n\n";
+        os << " --templateFitOOT        Include an out-of-time pulse, one time slice earlier\n"
+           << "                         than the in-time pulse, in the template fit of the\n"
+           << "                         channel pulses (\"templateFitNtuple\").\n\n";
     }
 
     std::string convertersGSSAFile;
+    std::string converterBankFile;
     std::string hbGeometryFile;
     std::string heGeometryFile;
+    std::string containmentCacheDir;
+    std::string channelPhasesFile;
+    std::string writeSidecarFile;
+    std::string readSidecarFile;
 
     double maxLogContribution;
+    double logliTableMinE;
+    double logliTableMaxE;
     double correctionPhaseNS;
 
     unsigned nPhiBins;
     unsigned minTSlice;
     unsigned maxTSlice;
+    unsigned logliTableSize;
 
     int hpdShapeNumber;
+
+    bool templateFitOOT;
 };
 
 std::ostream& operator<<(std::ostream& os, const NoiseTreeAnalysisOptions& o)
 {
     os << "converters = \"" << o.convertersGSSAFile << '"'
+       << ", converterBank = \"" << o.converterBankFile << '"'
        << ", hbgeo = \"" << o.hbGeometryFile << '"'
        << ", hegeo = \"" << o.heGeometryFile << '"'
+       << ", containmentCache = \"" << o.containmentCacheDir << '"'
+       << ", channelPhases = \"" << o.channelPhasesFile << '"'
+       << ", writeSidecar = \"" << o.writeSidecarFile << '"'
+       << ", readSidecar = \"" << o.readSidecarFile << '"'
        << ", maxLogContribution = " << o.maxLogContribution
+       << ", logliTableSize = " << o.logliTableSize
+       << ", logliTableMinE = " << o.logliTableMinE
+       << ", logliTableMaxE = " << o.logliTableMaxE
        << ", correctionPhaseNS = " << o.correctionPhaseNS
        << ", nPhiBins = " << o.nPhiBins
        << ", minTSlice = " << o.minTSlice
        << ", maxTSlice = " << o.maxTSlice
        << ", hpdShapeNumber = " << o.hpdShapeNumber
+       << ", templateFitOOT = " << o.templateFitOOT
         ;
     return os;
 }
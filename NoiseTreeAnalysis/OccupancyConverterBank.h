@@ -0,0 +1,66 @@
+#ifndef OccupancyConverterBank_h_
+#define OccupancyConverterBank_h_
+
+//
+// Occupancy converters for all channels in a single object with
+// contiguous storage. For each channel, this is equivalent to
+// npstat::LeftCensoredDistribution built with npstat::QuantileTable1D
+// (as done by the "analyzeEChanNtuple" program), assuming that the
+// censoring point is below all energies of interest.
+//
+// The quantile table of each channel is stored together with the
+// quantiles 0 and 1 (in the scaled coordinate). The table with n
+// interior quantiles q_0, ..., q_{n-1} corresponds to the cdf values
+// (i + 0.5)/n, and the quantile function is linear between these
+// points.
+//
+// The file format is a header of four 64-bit words (magic number,
+// format version, number of channels, number of quantile values)
+// followed by the arrays of channel locations, scales, visible
+// fractions, table offsets (nChannels + 1 values), and quantiles,
+// all 64 bits wide. The native byte order is used. Since the arrays
+// are written exactly as they are kept in memory, the whole file is
+// loaded with one read.
+//
+
+#include <vector>
+#include <cassert>
+
+class OccupancyConverterBank
+{
+public:
+    inline OccupancyConverterBank() : offset_(1, 0ULL) {}
+
+    // Append a channel. "quantiles" are the interior quantiles of
+    // the scaled distribution, as passed to npstat::QuantileTable1D.
+    void addChannel(double location, double scale, double visibleFraction,
+                    const double* quantiles, unsigned nQuantiles);
+
+    inline unsigned nChannels() const {return location_.size();}
+
+    inline double visibleFraction(const unsigned ch) const
+        {return fraction_.at(ch);}
+
+    // Exceedance of the censored distribution
+    inline double exceedance(const unsigned ch, const double x) const
+        {return fraction_.at(ch)*(1.0 - visibleCdf(ch, x));}
+
+    // Cdf of the visible (uncensored) part of the distribution
+    double visibleCdf(unsigned ch, double x) const;
+
+    // Returns "true" on success
+    bool write(const char* filename) const;
+
+    // Returns a new object (to be deleted by the caller). Throws
+    // std::runtime_error if the file can not be read or is corrupt.
+    static OccupancyConverterBank* read(const char* filename);
+
+private:
+    std::vector<double> location_;
+    std::vector<double> scale_;
+    std::vector<double> fraction_;
+    std::vector<unsigned long long> offset_;
+    std::vector<double> values_;
+};
+
+#endif // OccupancyConverterBank_h_
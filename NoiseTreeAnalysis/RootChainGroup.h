@@ -0,0 +1,126 @@
+#ifndef RootChainGroup_h_
+#define RootChainGroup_h_
+
+//
+// Runs several analyses derived from RootChainProcessor over the same
+// input chain, reading each chain entry only once. The entry is read
+// into a separate RootMadeClass object (the only one whose branch
+// addresses are connected to the chain) and then copied into each
+// analysis. Copying the event buffer is much cheaper than reading and
+// decompressing the entry again, so the I/O cost does not depend on
+// the number of analyses.
+//
+// Each analysis keeps its own options, "Cut", event counters, and
+// output. The "Notify" method of every analysis is called whenever
+// a new tree of the chain is loaded. Processing stops when all
+// analyses have processed their maximum number of events or when
+// any analysis returns a non-0 status.
+//
+
+#include <vector>
+#include <cassert>
+
+#include "RootChainProcessor.h"
+
+template <class RootMadeClass>
+class RootChainGroup
+{
+public:
+    typedef RootChainProcessor<RootMadeClass> processor_type;
+
+    // All analyses added to this group must process the same tree
+    inline explicit RootChainGroup(TTree *tree) : tree_(tree) {assert(tree);}
+
+    inline ~RootChainGroup()
+    {
+        for (unsigned i=0; i<analyses_.size(); ++i)
+            delete analyses_[i];
+    }
+
+    // The group takes ownership of the added analyses.
+    // The analyses are run in the order they are added.
+    inline void add(processor_type* analysis)
+    {
+        assert(analysis);
+        analyses_.push_back(analysis);
+    }
+
+    inline unsigned size() const {return analyses_.size();}
+    inline const processor_type& operator[](const unsigned i) const
+        {return *analyses_.at(i);}
+
+    // Run all analyses. The return value has the same meaning
+    // as the one of the RootChainProcessor "process" method
+    // (the first non-0 status encountered is returned).
+    int process();
+
+private:
+    RootChainGroup();
+    RootChainGroup(const RootChainGroup&);
+    RootChainGroup& operator=(const RootChainGroup&);
+
+    TTree* tree_;
+    std::vector<processor_type*> analyses_;
+};
+
+template <class RootMadeClass>
+int RootChainGroup<RootMadeClass>::process()
+{
+    const unsigned nAna = analyses_.size();
+    for (unsigned i=0; i<nAna; ++i)
+        analyses_[i]->setSharedChain(nAna > 1U);
+
+    int status = 0;
+    unsigned nBegun = 0;
+    for (; nBegun<nAna && !status; ++nBegun)
+        status = analyses_[nBegun]->beginProcessing();
+
+    // Connect the branches to the common buffer. This has to be done
+    // after all analyses are constructed because the constructor of
+    // each analysis connects the branches to its own data members.
+    RootMadeClass reader(tree_);
+    Int_t lastTree = -1;
+
+    // Analyses can be done before the first entry (e.g., if their
+    // maximum number of events is 0)
+    unsigned nActive = 0;
+    for (unsigned i=0; i<nAna; ++i)
+        if (!analyses_[i]->isDone())
+            ++nActive;
+
+    const Long64_t nentries = tree_->GetEntriesFast();
+    for (Long64_t jentry=0; jentry < nentries && nActive && !status; ++jentry)
+    {
+        const Long64_t ientry = reader.LoadTree(jentry);
+        if (ientry < 0) break;
+        tree_->GetEntry(jentry);
+        const bool newTree = reader.fCurrent != lastTree;
+        lastTree = reader.fCurrent;
+
+        for (unsigned i=0; i<nAna && !status; ++i)
+        {
+            processor_type* ana = analyses_[i];
+            if (ana->isDone())
+                continue;
+            ana->copyEventData(reader);
+            if (newTree)
+                ana->Notify();
+            status = ana->processEntry(ientry, jentry);
+            if (ana->isDone())
+                --nActive;
+        }
+    }
+
+    // The reader goes out of scope, so its addresses must not be used
+    tree_->ResetBranchAddresses();
+
+    for (unsigned i=0; i<nBegun; ++i)
+    {
+        const int endStatus = analyses_[i]->endProcessing(status);
+        if (!status)
+            status = endStatus;
+    }
+    return status;
+}
+
+#endif // RootChainGroup_h_
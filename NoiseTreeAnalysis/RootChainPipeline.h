@@ -0,0 +1,282 @@
+#ifndef RootChainPipeline_h_
+#define RootChainPipeline_h_
+
+//
+// Runs an analysis derived from RootChainProcessor as a pipeline:
+// the per-event calculations ("computeEvent") are performed by several
+// worker copies of the analysis, each in its own thread, while the
+// histograms and ntuples are filled ("fillEvent") by the original
+// analysis object strictly in the entry order. Because of this, the
+// output is identical to that of the serial "process" method.
+//
+// Root I/O is not thread-safe, so reading the entries and filling the
+// output are both done in the calling thread. They do not wait for each
+// other: the calling thread reads entries for as long as there are free
+// event slots and fills the next entry as soon as its calculation is
+// finished. Each slot holds a copy of the tree data members (the whole
+// event buffer) and the record made by the worker. Entry j is assigned
+// to worker j % nWorkers, so the order is preserved by passing the slots
+// through bounded lock-free single-producer/single-consumer queues, two
+// per worker (see SPSCQueue.h).
+//
+// The worker copies should be constructed with the same options and
+// histogram request as the filling analysis (so that they know which
+// quantities to calculate) but without an output file. They are marked
+// as pipeline workers before their "beginProcessing" is called, and
+// their histograms are booked outside of any root file. Only the filling
+// analysis has its "Notify" called when a new tree of the chain is
+// loaded, and only its event counters are meaningful.
+//
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <exception>
+#include <cassert>
+
+#include "TROOT.h"
+#include "TDirectory.h"
+
+#include "RootChainProcessor.h"
+#include "SPSCQueue.h"
+
+template <class RootMadeClass>
+class RootChainPipeline
+{
+public:
+    typedef RootChainProcessor<RootMadeClass> processor_type;
+
+    // "filler" is the analysis which fills the output. It is not
+    // owned by the pipeline. "queueDepth" is the number of entries
+    // which can be queued for each worker.
+    inline RootChainPipeline(TTree *tree, processor_type* filler,
+                             const unsigned queueDepth = 4U)
+        : tree_(tree), filler_(filler), queueDepth_(queueDepth)
+    {
+        assert(tree);
+        assert(filler);
+        assert(queueDepth);
+    }
+
+    inline ~RootChainPipeline()
+    {
+        for (unsigned i=0; i<workers_.size(); ++i)
+            delete workers_[i];
+    }
+
+    // The pipeline takes ownership of the added workers
+    inline void addWorker(processor_type* worker)
+    {
+        assert(worker);
+        assert(worker != filler_);
+        assert(worker->supportsPipeline());
+        worker->setPipelineWorker(true);
+        workers_.push_back(worker);
+    }
+
+    inline unsigned nWorkers() const {return workers_.size();}
+
+    // Run the analysis. The return value has the same meaning
+    // as the one of the RootChainProcessor "process" method.
+    // Without workers, "process" of the filling analysis is called.
+    int process();
+
+private:
+    RootChainPipeline();
+    RootChainPipeline(const RootChainPipeline&);
+    RootChainPipeline& operator=(const RootChainPipeline&);
+
+    struct Slot
+    {
+        inline explicit Slot(const RootMadeClass& r)
+            : data(r), ientry(-1), jentry(-1), status(0), newTree(false) {}
+
+        RootMadeClass data;
+        std::vector<char> record;
+        std::exception_ptr error;
+        Long64_t ientry;
+        Long64_t jentry;
+        int status;
+        bool newTree;
+    };
+
+    typedef SPSCQueue<Slot*> Queue;
+
+    static void runWorker(processor_type* worker, Queue* in, Queue* out);
+    static void stopWorkers(std::vector<std::unique_ptr<Queue> >& in,
+                            std::vector<std::thread>& threads);
+
+    TTree* tree_;
+    processor_type* filler_;
+    unsigned queueDepth_;
+    std::vector<processor_type*> workers_;
+};
+
+template <class RootMadeClass>
+void RootChainPipeline<RootMadeClass>::runWorker(
+    processor_type* worker, Queue* in, Queue* out)
+{
+    // Null slot pointer means that there is no more work
+    for (;;)
+    {
+        Slot* slot = 0;
+        while (!in->pop(&slot))
+            std::this_thread::yield();
+        if (!slot)
+            break;
+
+        // Exceptions are passed on to the calling thread
+        try {
+            worker->copyEventData(slot->data);
+            slot->status = worker->computeEntry(slot->ientry, slot->jentry,
+                                                 &slot->record);
+        }
+        catch (...) {
+            slot->error = std::current_exception();
+        }
+
+        while (!out->push(slot))
+            std::this_thread::yield();
+    }
+}
+
+template <class RootMadeClass>
+void RootChainPipeline<RootMadeClass>::stopWorkers(
+    std::vector<std::unique_ptr<Queue> >& in,
+    std::vector<std::thread>& threads)
+{
+    const unsigned nThreads = threads.size();
+    for (unsigned i=0; i<nThreads; ++i)
+        while (!in[i]->push(0))
+            std::this_thread::yield();
+    for (unsigned i=0; i<nThreads; ++i)
+        threads[i].join();
+    threads.clear();
+}
+
+template <class RootMadeClass>
+int RootChainPipeline<RootMadeClass>::process()
+{
+    const unsigned nW = workers_.size();
+    if (!nW)
+        return filler_->process();
+
+    int status = filler_->beginProcessing();
+
+    // Keep the histograms of the workers out of the output file
+    unsigned nBegun = 0;
+    {
+        TDirectory* savedDir = gDirectory;
+        gROOT->cd();
+        for (; nBegun<nW && !status; ++nBegun)
+            status = workers_[nBegun]->beginProcessing();
+        savedDir->cd();
+    }
+
+    if (!status)
+    {
+        // Connect the branches to the common buffer. This has to be
+        // done after all analyses are constructed (see RootChainGroup.h).
+        RootMadeClass reader(tree_);
+
+        // Event slots and the queues which pass them to the workers
+        // and back. The input queues also need room for the stop signal.
+        const Long64_t nSlots = static_cast<Long64_t>(nW)*queueDepth_;
+        std::vector<std::unique_ptr<Slot> > slots;
+        slots.reserve(nSlots);
+        for (Long64_t i=0; i<nSlots; ++i)
+            slots.push_back(std::unique_ptr<Slot>(new Slot(reader)));
+
+        std::vector<std::unique_ptr<Queue> > in, out;
+        in.reserve(nW);
+        out.reserve(nW);
+        for (unsigned i=0; i<nW; ++i)
+        {
+            in.push_back(std::unique_ptr<Queue>(new Queue(queueDepth_ + 1U)));
+            out.push_back(std::unique_ptr<Queue>(new Queue(queueDepth_)));
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(nW);
+        try {
+            for (unsigned i=0; i<nW; ++i)
+                threads.push_back(std::thread(runWorker, workers_[i],
+                                              in[i].get(), out[i].get()));
+
+            const Long64_t nentries = tree_->GetEntriesFast();
+            Long64_t nRead = 0, nFilled = 0;
+            Int_t lastTree = -1;
+            bool moreInput = true;
+            while (!status)
+            {
+                // Read entries into all free slots. The slot of an
+                // entry is free once the entry nSlots before it has
+                // been filled.
+                for (; moreInput && nRead - nFilled < nSlots; ++nRead)
+                {
+                    const Long64_t ientry = nRead < nentries ?
+                        reader.LoadTree(nRead) : -1;
+                    if (ientry < 0)
+                    {
+                        moreInput = false;
+                        break;
+                    }
+                    tree_->GetEntry(nRead);
+
+                    Slot* slot = slots[nRead % nSlots].get();
+                    slot->data = reader;
+                    slot->ientry = ientry;
+                    slot->jentry = nRead;
+                    slot->status = 0;
+                    slot->error = std::exception_ptr();
+                    slot->newTree = reader.fCurrent != lastTree;
+                    lastTree = reader.fCurrent;
+                    while (!in[nRead % nW]->push(slot))
+                        std::this_thread::yield();
+                }
+                if (nFilled == nRead)
+                    break;
+
+                // Fill the next entry when the worker is done with it
+                Slot* slot = 0;
+                if (!out[nFilled % nW]->pop(&slot))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                ++nFilled;
+                if (slot->error)
+                    std::rethrow_exception(slot->error);
+                status = slot->status;
+                if (!status)
+                {
+                    filler_->copyEventData(slot->data);
+                    if (slot->newTree)
+                        filler_->Notify();
+                    status = filler_->fillEntry(slot->ientry, slot->jentry,
+                                                slot->record);
+                }
+                if (filler_->isDone())
+                    break;
+            }
+        }
+        catch (...) {
+            stopWorkers(in, threads);
+            throw;
+        }
+        stopWorkers(in, threads);
+
+        // The reader goes out of scope, so its addresses must not be used
+        tree_->ResetBranchAddresses();
+    }
+
+    for (unsigned i=0; i<nBegun; ++i)
+    {
+        const int endStatus = workers_[i]->endProcessing(status);
+        if (!status)
+            status = endStatus;
+    }
+    return filler_->endProcessing(status);
+}
+
+#endif // RootChainPipeline_h_
@@ -15,6 +15,7 @@
 // March 2013
 //
 
+#include <vector>
 #include <cassert>
 #include "TTree.h"
 
@@ -22,12 +23,18 @@ template <class RootMadeClass>
 class RootChainProcessor : public RootMadeClass
 {
 public:
+    // The class generated by "MakeClass" which holds the tree data
+    typedef RootMadeClass tree_type;
+
     // Call the constructor with the input chain
     inline RootChainProcessor(TTree *tree, Long64_t maxEvents)
         : RootMadeClass(tree),
           eventCounter_(0),
           processCounter_(0),
-          maxEvents_(maxEvents)
+          maxEvents_(maxEvents),
+          chainEntry_(-1),
+          pipelineWorker_(false),
+          sharedChain_(false)
     {
         assert(tree);
     }
@@ -41,9 +48,7 @@ public:
     // returning from "main").
     inline int process()
     {
-        int status = this->beginJob();
-        eventCounter_ = 0;
-        processCounter_ = 0;
+        int status = beginProcessing();
         assert(this->fChain);
         const Long64_t nentries = this->fChain->GetEntriesFast();
         for (Long64_t jentry=0; jentry < nentries && !status; ++jentry)
@@ -51,13 +56,49 @@ public:
             Long64_t ientry = this->LoadTree(jentry);
             if (ientry < 0) break;
             this->fChain->GetEntry(jentry);
-            ++eventCounter_;
-            if (this->Cut(ientry) < 0)
-                continue;
-            status = this->event(ientry);
-            if (++processCounter_ >= maxEvents_)
+            status = processEntry(ientry, jentry);
+            if (isDone())
                 break;
         }
+        return endProcessing(status);
+    }
+
+    inline Long64_t getEventCounter() const {return eventCounter_;}
+    inline Long64_t getProcessCounter() const {return processCounter_;}
+
+    // Number of the current entry in the whole chain. The entry
+    // numbers passed to "Cut", "event", etc are tree-local.
+    inline Long64_t getChainEntry() const {return chainEntry_;}
+
+    // The following methods are the individual steps of "process".
+    // They are used by RootChainGroup which runs several analyses
+    // over a single read of the input chain. "processEntry" assumes
+    // that the tree data members have already been filled for the
+    // current entry (normally, by "copyEventData"). "ientry" is the
+    // entry number in the current tree, "jentry" in the whole chain.
+    inline int beginProcessing()
+    {
+        eventCounter_ = 0;
+        processCounter_ = 0;
+        return this->beginJob();
+    }
+
+    inline int processEntry(const Long64_t ientry, const Long64_t jentry)
+    {
+        chainEntry_ = jentry;
+        ++eventCounter_;
+        if (this->Cut(ientry) < 0)
+            return 0;
+        ++processCounter_;
+        return this->event(ientry);
+    }
+
+    inline bool isDone() const {return processCounter_ >= maxEvents_;}
+
+    // The argument is the status of the event cycle. The status
+    // returned by "endJob" is used only if this argument is 0.
+    inline int endProcessing(const int status)
+    {
         const int endStatus = this->endJob();
         if (status)
             return status;
@@ -65,8 +106,56 @@ public:
             return endStatus;
     }
 
-    inline Long64_t getEventCounter() const {return eventCounter_;}
-    inline Long64_t getProcessCounter() const {return processCounter_;}
+    // Copy the tree data members (the whole event buffer)
+    // from another object which has read the current entry
+    inline void copyEventData(const RootMadeClass& source)
+        {RootMadeClass::operator=(source);}
+
+    // The following methods are used by RootChainPipeline which
+    // splits the event processing into the calculation stage, run
+    // in several threads, and the filling stage. "computeEntry" is
+    // called for the worker copies of the analysis, "fillEntry" for
+    // the analysis which fills the output. Both assume that the tree
+    // data members have been filled for the current entry. The cut
+    // is applied in both stages; the event counters are incremented
+    // by "fillEntry" only.
+    inline int computeEntry(const Long64_t ientry, const Long64_t jentry,
+                            std::vector<char>* record)
+    {
+        assert(record);
+        chainEntry_ = jentry;
+        record->clear();
+        if (this->Cut(ientry) < 0)
+            return 0;
+        return this->computeEvent(ientry, record);
+    }
+
+    inline int fillEntry(const Long64_t ientry, const Long64_t jentry,
+                         const std::vector<char>& record)
+    {
+        chainEntry_ = jentry;
+        ++eventCounter_;
+        if (this->Cut(ientry) < 0)
+            return 0;
+        ++processCounter_;
+        return this->fillEvent(ientry, record);
+    }
+
+    // Derived classes which override "computeEvent" and "fillEvent"
+    // should return "true" here. Running other analyses in a pipeline
+    // would only add the cost of copying the event buffers.
+    virtual bool supportsPipeline() const {return false;}
+
+    // The pipeline marks its worker copies of the analysis before
+    // calling "beginProcessing". Workers should not write any output.
+    inline void setPipelineWorker(const bool b) {pipelineWorker_ = b;}
+    inline bool isPipelineWorker() const {return pipelineWorker_;}
+
+    // RootChainGroup marks its analyses if there is more than one.
+    // Such analyses should not change the status of the chain
+    // branches because other analyses may need them.
+    inline void setSharedChain(const bool b) {sharedChain_ = b;}
+    inline bool isChainShared() const {return sharedChain_;}
 
 protected:
     // Derived classes should override the following
@@ -76,6 +165,21 @@ protected:
     virtual int event(Long64_t entryNumber) = 0;
     virtual int endJob() = 0;
 
+    // Derived classes can override the following two methods in order
+    // to benefit from the pipelined processing. "computeEvent" runs in
+    // a worker thread. It should calculate the per-event quantities
+    // without touching any objects which are not owned by this analysis
+    // (root histograms and files, in particular) and serialize the
+    // results into "record". "fillEvent" gets this record, in the entry
+    // order, and should fill the histograms. The default implementations
+    // do all the work in "fillEvent" by calling "event".
+    virtual int computeEvent(Long64_t /* entryNumber */,
+                             std::vector<char>* /* record */)
+        {return 0;}
+    virtual int fillEvent(Long64_t entryNumber,
+                          const std::vector<char>& /* record */)
+        {return this->event(entryNumber);}
+
 private:
     // Disable default constructors and assignment operator
     RootChainProcessor();
@@ -85,6 +189,9 @@ private:
     Long64_t eventCounter_;
     Long64_t processCounter_;
     Long64_t maxEvents_;
+    Long64_t chainEntry_;
+    bool pipelineWorker_;
+    bool sharedChain_;
 };
 
 #endif // RootChainProcessor_h_
@@ -0,0 +1,79 @@
+#ifndef SPSCQueue_h_
+#define SPSCQueue_h_
+
+//
+// Bounded lock-free queue with exactly one producer thread and exactly
+// one consumer thread. The items are kept in a ring buffer whose size
+// is a power of 2. The producer advances the "tail" counter and the
+// consumer advances the "head" counter, so that each counter is written
+// by one thread only and no locks or read-modify-write operations are
+// needed. The counters are placed on separate cache lines.
+//
+// "push" and "pop" never block; they return "false" if the queue is
+// full or empty, respectively. Waiting (spinning, yielding, etc) is up
+// to the caller. Items are copied in and out, so T should normally be
+// something small, like a pointer.
+//
+
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+template <typename T>
+class SPSCQueue
+{
+public:
+    // The capacity is "minCapacity" rounded up to a power of 2
+    inline explicit SPSCQueue(const unsigned long minCapacity)
+        : head_(0UL), tail_(0UL)
+    {
+        assert(minCapacity);
+        unsigned long capacity = 1UL;
+        while (capacity < minCapacity)
+            capacity *= 2UL;
+        buf_.resize(capacity);
+        mask_ = capacity - 1UL;
+    }
+
+    inline unsigned long capacity() const {return mask_ + 1UL;}
+
+    // To be called by the producer thread only
+    inline bool push(const T& item)
+    {
+        const unsigned long tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_)
+            return false;
+        buf_[tail & mask_] = item;
+        tail_.store(tail + 1UL, std::memory_order_release);
+        return true;
+    }
+
+    // To be called by the consumer thread only
+    inline bool pop(T* item)
+    {
+        assert(item);
+        const unsigned long head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+        *item = buf_[head & mask_];
+        head_.store(head + 1UL, std::memory_order_release);
+        return true;
+    }
+
+private:
+    SPSCQueue();
+    SPSCQueue(const SPSCQueue&);
+    SPSCQueue& operator=(const SPSCQueue&);
+
+    enum {CacheLine = 64};
+
+    std::vector<T> buf_;
+    unsigned long mask_;
+    char pad0_[CacheLine];
+    std::atomic<unsigned long> head_;
+    char pad1_[CacheLine - sizeof(std::atomic<unsigned long>)];
+    std::atomic<unsigned long> tail_;
+    char pad2_[CacheLine - sizeof(std::atomic<unsigned long>)];
+};
+
+#endif // SPSCQueue_h_
@@ -0,0 +1,60 @@
+#ifndef SharedChannelIndex_h_
+#define SharedChannelIndex_h_
+
+//
+// Linear channel numbers of the pulses in the current event. This
+// lookup does not depend on the analysis options, so it is shared by
+// all analysis objects which process the same entry (e.g., option
+// variants run over a single read of the input). The numbers are
+// looked up by the first object which sees a new entry, the others
+// just reuse them.
+//
+// The entry is identified by the tree number in the chain and the
+// entry number in that tree, so all analyses which use the shared
+// instance must process the same chain.
+//
+
+#include <vector>
+
+#include "HBHEChannelMap.h"
+
+class SharedChannelIndex
+{
+public:
+    inline SharedChannelIndex()
+        : channels_(HBHEChannelMap::ChannelCount),
+          treeNumber_(-1), entry_(-1) {}
+
+    // Returns the array of channel numbers indexed by pulse number
+    template<class TreeData>
+    inline const unsigned* lookup(const HBHEChannelMap& channelMap,
+                                  const TreeData& treeData,
+                                  const int treeNumber,
+                                  const long long entry)
+    {
+        if (treeNumber != treeNumber_ || entry != entry_)
+        {
+            const int nPulses = treeData.PulseCount;
+            for (int i=0; i<nPulses; ++i)
+                channels_.at(i) = channelMap.linearIndex(
+                    treeData.Depth[i], treeData.IEta[i], treeData.IPhi[i]);
+            treeNumber_ = treeNumber;
+            entry_ = entry;
+        }
+        return &channels_[0];
+    }
+
+    // The object shared by all analyses in the program
+    static inline SharedChannelIndex& instance()
+    {
+        static SharedChannelIndex index;
+        return index;
+    }
+
+private:
+    std::vector<unsigned> channels_;
+    int treeNumber_;
+    long long entry_;
+};
+
+#endif // SharedChannelIndex_h_
@@ -0,0 +1,94 @@
+#ifndef TouchedIndexList_h_
+#define TouchedIndexList_h_
+
+//
+// List of array indices modified since the last reset. Used to clean
+// up per-event working arrays by resetting only the elements actually
+// written, so that the cost of the cleanup scales with the number of
+// modified elements rather than with the array size.
+//
+// Typical usage:
+//
+//   TouchedIndexList touched(arraySize);
+//   ...
+//   array[i] = something;
+//   touched.touch(i);
+//   ...
+//   touched.resetArray(array, initialValue);
+//
+
+#include <vector>
+#include <cassert>
+
+class TouchedIndexList
+{
+public:
+    inline explicit TouchedIndexList(const unsigned maxIndex)
+        : flags_(maxIndex, 0) {list_.reserve(maxIndex);}
+
+    // Mark the index as touched. Returns "true" if the index
+    // was not touched before.
+    inline bool touch(const unsigned i)
+    {
+        assert(i < flags_.size());
+        if (flags_[i])
+            return false;
+        flags_[i] = 1;
+        list_.push_back(i);
+        return true;
+    }
+
+    inline bool isTouched(const unsigned i) const
+        {return flags_.at(i);}
+
+    // Indices in the order they were touched
+    inline unsigned size() const {return list_.size();}
+    inline bool empty() const {return list_.empty();}
+    inline unsigned operator[](const unsigned k) const {return list_[k];}
+    inline const std::vector<unsigned>& indices() const {return list_;}
+
+    inline unsigned maxIndex() const {return flags_.size();}
+
+    // Forget all touched indices
+    inline void clear()
+    {
+        const unsigned n = list_.size();
+        for (unsigned k=0; k<n; ++k)
+            flags_[list_[k]] = 0;
+        list_.clear();
+    }
+
+    // Set the touched elements of the array to "value",
+    // then forget the touched indices
+    template<typename T>
+    inline void resetArray(T* array, const T& value)
+    {
+        const unsigned n = list_.size();
+        for (unsigned k=0; k<n; ++k)
+            array[list_[k]] = value;
+        clear();
+    }
+
+    // Same thing for the rows of a two-dimensional array
+    // (the first array index must be the touched one)
+    template<typename T, unsigned N>
+    inline void resetRows(T (*array)[N], const T& value)
+    {
+        const unsigned n = list_.size();
+        for (unsigned k=0; k<n; ++k)
+        {
+            T* row = array[list_[k]];
+            for (unsigned j=0; j<N; ++j)
+                row[j] = value;
+        }
+        clear();
+    }
+
+private:
+    TouchedIndexList();
+
+    std::vector<unsigned char> flags_;
+    std::vector<unsigned> list_;
+};
+
+#endif // TouchedIndexList_h_
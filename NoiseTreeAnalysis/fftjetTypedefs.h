@@ -7,8 +7,9 @@
 // Classes which build 4-momenta out of energy and direction
 #include "VBuilders.h"
 
-// Header file for the concrete FFT engine used
+// Header files for the concrete FFT engines used
 #include "fftjet/FFTWDoubleEngine.hh"
+#include "fftjet/FFTWFloatEngine.hh"
 
 // Header file for the functor interface
 #include "fftjet/SimpleFunctors.hh"
@@ -19,6 +20,23 @@ typedef double Real;
 typedef fftw_complex Complex;
 typedef fftjet::FFTWDoubleEngine MyFFTEngine;
 
+// The FFTW complex type and the FFT engine matching the precision
+// of the energy flow grid. Only "double" (the default) and "float"
+// grids are supported.
+template <typename GridReal> struct FFTWPrecision;
+
+template <> struct FFTWPrecision<double>
+{
+    typedef fftw_complex Complex;
+    typedef fftjet::FFTWDoubleEngine Engine;
+};
+
+template <> struct FFTWPrecision<float>
+{
+    typedef fftwf_complex Complex;
+    typedef fftjet::FFTWFloatEngine Engine;
+};
+
 // The next typedef reflects the choice of the 4-vector class
 typedef TLorentzVector VectorLike;
 